@@ -0,0 +1,301 @@
+#ifndef GRAPH_ADJACENCY_MATRIX_H
+#define GRAPH_ADJACENCY_MATRIX_H
+
+#include <algorithm>  //for std::max, std::fill, std::copy
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t, std::ptrdiff_t
+#include <cstdint>    //for std::uint32_t, std::uint64_t
+#include <iterator>   //for std::forward_iterator_tag
+#include <vector>     //for std::vector
+#include "Graph/include/bit_row.h"
+#include "Graph/include/id_access.h"
+#include "Graph/include/vertex.h"
+
+/** \file
+ *  \brief undirected_graph/directed_graph的邻接存储策略(第四个模板参数).
+ *
+ * set_adjacency(默认)把每个顶点的关联边存放在顶点的std::set中,adjacent/get_edge在集合中查找.
+ * matrix_adjacency不再维护这些集合,而以一个位矩阵与一个边index矩阵(按顶点index,边index为32位)作为邻接存储:
+ * adjacent/get_edge为O(1),associated_edges按相邻顶点的index升序扫描位行,
+ * 并可按行取得邻居的位集,以逐字的位运算求公共邻居与邻居的并.
+ * 矩阵占用O(V^2)的内存(每对顶点4字节加1位),没有每条边的结点开销,适合顶点不多而边很稠密的图.
+ * matrix_adjacency不支持平行边:两个顶点之间(有向图为同一方向上)至多一条边.
+ */
+
+namespace lzhlib
+{
+    struct set_adjacency
+    {
+        static constexpr bool indexed = false;
+
+        void add_vertex(std::size_t) noexcept
+        {}
+        void remove_vertex(std::size_t) noexcept
+        {}
+        std::size_t memory_usage() const noexcept
+        {
+            return 0;
+        }
+    };
+
+    //矩阵一行中的边,按相邻顶点的index升序.迭代器不引用range本身,range可以是临时对象
+    class matrix_edge_range
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = detail::edge_ref;
+            using difference_type = std::ptrdiff_t;
+            using pointer = detail::edge_ref const*;
+            using reference = detail::edge_ref const&;
+
+            iterator(std::uint64_t const* words, std::uint32_t const* slots, std::size_t word_count, std::size_t position) noexcept
+                : words(words), slots(slots), word_count(word_count), position(position),
+                  current(detail::id_access::make_edge_id(0), detail::id_access::make_vertex_id(0))
+            {
+                settle();
+            }
+
+            reference operator*() const noexcept
+            {
+                return current;
+            }
+            pointer operator->() const noexcept
+            {
+                return &current;
+            }
+            iterator& operator++() noexcept
+            {
+                ++position;
+                settle();
+                return *this;
+            }
+            iterator operator++(int) noexcept
+            {
+                iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(iterator const& rhs) const noexcept
+            {
+                return position == rhs.position;
+            }
+            bool operator!=(iterator const& rhs) const noexcept
+            {
+                return position != rhs.position;
+            }
+
+        private:
+            void settle() noexcept          //移到position及其后的第一个置位处,没有时移到末尾
+            {
+                std::size_t const end = word_count * 64;
+                if (position >= end)
+                {
+                    position = end;
+                    return;
+                }
+                std::size_t w = position / 64;
+                std::uint64_t bits = words[w] & (~std::uint64_t(0) << (position % 64));
+                while (bits == 0 && ++w != word_count)
+                    bits = words[w];
+                if (bits == 0)
+                {
+                    position = end;
+                    return;
+                }
+                position = w * 64 + detail::lowest_bit(bits);
+                current = detail::edge_ref(detail::id_access::make_edge_id(slots[position]),
+                                           detail::id_access::make_vertex_id(position));
+            }
+
+            std::uint64_t const* words;
+            std::uint32_t const* slots;
+            std::size_t word_count;
+            std::size_t position;
+            detail::edge_ref current;
+        };
+        using const_iterator = iterator;
+
+        matrix_edge_range(std::uint64_t const* words, std::uint32_t const* slots, std::size_t word_count) noexcept
+            : words(words), slots(slots), word_count(word_count)
+        {}
+
+        iterator begin() const noexcept
+        {
+            return {words, slots, word_count, 0};
+        }
+        iterator end() const noexcept
+        {
+            return {words, slots, word_count, word_count * 64};
+        }
+        std::size_t size() const noexcept
+        {
+            return bit_row(words, word_count).count();
+        }
+        bool empty() const noexcept
+        {
+            return begin() == end();
+        }
+
+    private:
+        std::uint64_t const* words;
+        std::uint32_t const* slots;
+        std::size_t word_count;
+    };
+
+    class matrix_adjacency
+    {
+    public:
+        static constexpr bool indexed = true;
+
+        void add_vertex(std::size_t v)
+        {
+            if (v >= capacity)
+                grow(std::max<std::size_t>({v + 1, capacity * 2, 64}));
+        }
+        void remove_vertex(std::size_t v)       //清除v的行与列
+        {
+            std::fill(row_words(v), row_words(v) + words_per_row, 0);
+            std::fill(edges.begin() + v * capacity, edges.begin() + (v + 1) * capacity, std::uint32_t(no_edge));
+            for (std::size_t x = 0; x != capacity; ++x)
+                reset(x, v);
+        }
+        void add_edge(std::size_t x, std::size_t y, edge_id e, bool directed)  //precondition: !adjacent(x, y)
+        {
+            assert(!adjacent(x, y) && "matrix_adjacency does not support parallel edges");
+            set(x, y, e);
+            if (!directed)
+                set(y, x, e);
+        }
+        void remove_edge(std::size_t x, std::size_t y, bool directed) noexcept
+        {
+            reset(x, y);
+            if (!directed)
+                reset(y, x);
+        }
+        //对与v关联的每条边调用f(edge_id):v的行,有向图另加v的列(自环只出现一次).O(V)
+        template<class F>
+        void for_each_incident_edge(std::size_t v, bool directed, F f) const
+        {
+            for (detail::edge_ref r : edges_of(v))
+                f(r.edge());
+            if (directed)
+                for (std::size_t x = 0; x != capacity; ++x)
+                    if (x != v && adjacent(x, v))
+                        f(edge(x, v));
+        }
+
+        bool adjacent(std::size_t x, std::size_t y) const noexcept
+        {
+            return (row_words(x)[y / 64] >> (y % 64)) & 1;
+        }
+        edge_id edge(std::size_t x, std::size_t y) const    //precondition: adjacent(x, y)
+        {
+            return detail::id_access::make_edge_id(edges[x * capacity + y]);
+        }
+        bit_row row(std::size_t x) const noexcept
+        {
+            return {row_words(x), words_per_row};
+        }
+        matrix_edge_range edges_of(std::size_t x) const noexcept
+        {
+            return {row_words(x), edges.data() + x * capacity, words_per_row};
+        }
+
+        std::size_t memory_usage() const noexcept
+        {
+            return bits.capacity() * sizeof(std::uint64_t) + edges.capacity() * sizeof(std::uint32_t);
+        }
+
+    private:
+        static constexpr std::uint32_t no_edge = static_cast<std::uint32_t>(-1);
+
+        std::uint64_t* row_words(std::size_t x) noexcept
+        {
+            return bits.data() + x * words_per_row;
+        }
+        std::uint64_t const* row_words(std::size_t x) const noexcept
+        {
+            return bits.data() + x * words_per_row;
+        }
+        void set(std::size_t x, std::size_t y, edge_id e)
+        {
+            std::size_t const i = detail::id_access::to_stock_id(e).id();
+            assert(i < no_edge);
+            row_words(x)[y / 64] |= std::uint64_t(1) << (y % 64);
+            edges[x * capacity + y] = static_cast<std::uint32_t>(i);
+        }
+        void reset(std::size_t x, std::size_t y) noexcept
+        {
+            row_words(x)[y / 64] &= ~(std::uint64_t(1) << (y % 64));
+            edges[x * capacity + y] = no_edge;
+        }
+        void grow(std::size_t n)
+        {
+            n = (n + 63) / 64 * 64;
+            std::size_t const words = n / 64;
+            std::vector<std::uint64_t> new_bits(n * words, 0);
+            std::vector<std::uint32_t> new_edges(n * n, std::uint32_t(no_edge));
+            for (std::size_t x = 0; x != capacity; ++x)
+            {
+                std::copy(row_words(x), row_words(x) + words_per_row, new_bits.begin() + x * words);
+                std::copy(edges.begin() + x * capacity, edges.begin() + (x + 1) * capacity, new_edges.begin() + x * n);
+            }
+            bits.swap(new_bits);
+            edges.swap(new_edges);
+            capacity = n;
+            words_per_row = words;
+        }
+
+        std::size_t capacity = 0;        //行数与列数,64的倍数
+        std::size_t words_per_row = 0;
+        std::vector<std::uint64_t> bits;
+        std::vector<std::uint32_t> edges;   //边的index;只在对应的位置位时有意义
+    };
+
+    //以下函数要求GraphT的AdjacencyT为matrix_adjacency,逐字对两行做位运算.结果按index升序
+    template<class GraphT>
+    std::size_t common_neighbor_count(GraphT const& g, vertex_id x, vertex_id y)
+    {
+        bit_row a = g.neighbor_row(x);
+        bit_row b = g.neighbor_row(y);
+        std::size_t ret = 0;
+        for (std::size_t w = 0; w != a.word_count(); ++w)
+            ret += detail::popcount(a.data()[w] & b.data()[w]);
+        return ret;
+    }
+    template<class GraphT>
+    std::vector<vertex_id> common_neighbors(GraphT const& g, vertex_id x, vertex_id y)
+    {
+        bit_row a = g.neighbor_row(x);
+        bit_row b = g.neighbor_row(y);
+        std::vector<std::uint64_t> both(a.word_count());
+        for (std::size_t w = 0; w != both.size(); ++w)
+            both[w] = a.data()[w] & b.data()[w];
+        std::vector<vertex_id> ret;
+        detail::for_each_bit(both.data(), both.size(), [&](std::size_t i)
+        {
+            ret.push_back(detail::id_access::make_vertex_id(i));
+        });
+        return ret;
+    }
+    template<class GraphT>
+    std::vector<vertex_id> neighbor_union(GraphT const& g, vertex_id x, vertex_id y)
+    {
+        bit_row a = g.neighbor_row(x);
+        bit_row b = g.neighbor_row(y);
+        std::vector<std::uint64_t> either(a.word_count());
+        for (std::size_t w = 0; w != either.size(); ++w)
+            either[w] = a.data()[w] | b.data()[w];
+        std::vector<vertex_id> ret;
+        detail::for_each_bit(either.data(), either.size(), [&](std::size_t i)
+        {
+            ret.push_back(detail::id_access::make_vertex_id(i));
+        });
+        return ret;
+    }
+}
+
+#endif //GRAPH_ADJACENCY_MATRIX_H
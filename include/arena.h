@@ -0,0 +1,145 @@
+#ifndef GRAPH_ARENA_H
+#define GRAPH_ARENA_H
+
+#include <cstddef>        //for std::size_t
+#include <cstdint>        //for std::uintptr_t
+#include <type_traits>    //for std::true_type
+
+/** \file
+ *  \brief 单调(只增不减)的内存池与对应的分配器.
+ *
+ * 把arena_allocator作为graph的最后一个模板实参,图的所有存储(顶点,边,邻接集合的结点)都从同一个
+ * monotonic_arena中分配.deallocate不做任何事,内存在arena析构或release()时一次性归还,
+ * 因而图析构时不会再频繁调用malloc/free.
+ * arena必须比使用它的图活得更久.
+ */
+
+namespace lzhlib
+{
+    class monotonic_arena
+    {
+    public:
+        explicit monotonic_arena(std::size_t initial_block_size = 64 * 1024)
+            : next_block_size(initial_block_size < min_block_size ? min_block_size : initial_block_size)
+        {}
+        monotonic_arena(monotonic_arena const&) = delete;
+        monotonic_arena& operator=(monotonic_arena const&) = delete;
+        ~monotonic_arena()
+        {
+            release();
+        }
+
+        void* allocate(std::size_t bytes, std::size_t alignment)
+        {
+            char* p = align_up(cursor, alignment);
+            if (cursor == nullptr || p + bytes > end)
+            {
+                add_block(bytes + alignment);
+                p = align_up(cursor, alignment);
+            }
+            cursor = p + bytes;
+            used += bytes;
+            return p;
+        }
+        void release() noexcept     //frees every block at once.Everything allocated from this arena becomes invalid.
+        {
+            while (blocks != nullptr)
+            {
+                block_header* next = blocks->next;
+                ::operator delete(blocks);
+                blocks = next;
+            }
+            cursor = end = nullptr;
+            used = reserved = 0;
+        }
+
+        std::size_t bytes_allocated() const noexcept
+        {
+            return used;
+        }
+        std::size_t bytes_reserved() const noexcept
+        {
+            return reserved;
+        }
+
+    private:
+        struct block_header
+        {
+            block_header* next;
+            std::size_t size;
+        };
+        static constexpr std::size_t min_block_size = 1024;
+
+        static char* align_up(char* p, std::size_t alignment)
+        {
+            auto address = reinterpret_cast<std::uintptr_t>(p);
+            return reinterpret_cast<char*>((address + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+        }
+        void add_block(std::size_t at_least)
+        {
+            std::size_t size = next_block_size;
+            while (size < at_least + sizeof(block_header))
+                size *= 2;
+            auto header = static_cast<block_header*>(::operator new(size));
+            header->next = blocks;
+            header->size = size;
+            blocks = header;
+            cursor = reinterpret_cast<char*>(header + 1);
+            end = reinterpret_cast<char*>(header) + size;
+            reserved += size;
+            next_block_size = size * 2;
+        }
+
+        block_header* blocks = nullptr;
+        char* cursor = nullptr;
+        char* end = nullptr;
+        std::size_t next_block_size;
+        std::size_t used = 0;
+        std::size_t reserved = 0;
+    };
+
+    template<class T>
+    class arena_allocator
+    {
+        template<class>
+        friend
+        class arena_allocator;
+
+    public:
+        using value_type = T;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        explicit arena_allocator(monotonic_arena& a) noexcept
+            : arena(&a)
+        {}
+        template<class U>
+        arena_allocator(arena_allocator<U> const& other) noexcept
+            : arena(other.arena)
+        {}
+
+        T* allocate(std::size_t n)
+        {
+            return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T*, std::size_t) noexcept
+        {
+        }
+
+        template<class U>
+        bool operator==(arena_allocator<U> const& rhs) const noexcept
+        {
+            return arena == rhs.arena;
+        }
+        template<class U>
+        bool operator!=(arena_allocator<U> const& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        monotonic_arena* arena;
+    };
+}
+
+#endif //GRAPH_ARENA_H
@@ -0,0 +1,237 @@
+#ifndef GRAPH_BETWEENNESS_H
+#define GRAPH_BETWEENNESS_H
+
+#include <algorithm>  //for std::min, std::max, std::fill
+#include <atomic>     //for std::atomic
+#include <cassert>    //for assert
+#include <cmath>      //for std::log, std::ceil
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <functional> //for std::greater, std::ref
+#include <limits>     //for std::numeric_limits
+#include <queue>      //for std::priority_queue
+#include <random>     //for std::mt19937_64, std::uniform_int_distribution
+#include <thread>     //for std::thread
+#include <utility>    //for std::pair
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief Brandes算法计算betweenness中心性.
+ *
+ * 源点被多个线程动态领取,每个线程有自己的累加数组与工作数组,全部结束后再相加,线程之间不共享可写数据.
+ * 反向累加时只沿出边检查"v是否为w的后继",因此不需要保存前驱表,也不需要有向图的转置.
+ * 结果按csr_graph的稠密编号排列,未归一化;无向图中每对顶点只计一次.
+ */
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        class brandes_worker
+        {
+        public:
+            using index_t = csr_graph::index_t;
+
+            brandes_worker(csr_graph const& g, std::vector<double> const* weights)
+                : g(g), weights(weights), score(g.vertex_count(), 0), sigma(g.vertex_count(), 0),
+                  distance(g.vertex_count(), unreached()), delta(g.vertex_count(), 0)
+            {
+                order.reserve(g.vertex_count());
+            }
+
+            void accumulate(index_t s, double scale)    //把以s为源点的依赖值乘以scale加到score上
+            {
+                if (weights == nullptr)
+                    breadth_first(s);
+                else
+                    dijkstra(s);
+                for (std::size_t k = order.size(); k-- != 0;)
+                {
+                    index_t w = order[k];
+                    std::size_t const first = g.offset(w);
+                    auto neighbors = g.neighbors(w);
+                    for (std::size_t j = 0; j != neighbors.size(); ++j)
+                    {
+                        index_t v = neighbors[j];
+                        if (distance[v] == distance[w] + length(first + j) && !(v == w))
+                            delta[w] += sigma[w] / sigma[v] * (1 + delta[v]);
+                    }
+                    if (w != s)
+                        score[w] += scale * delta[w];
+                }
+                for (index_t v : order)     //只重置本次到达的顶点
+                {
+                    sigma[v] = 0;
+                    distance[v] = unreached();
+                    delta[v] = 0;
+                }
+                order.clear();
+            }
+
+            std::vector<double> const& result() const noexcept
+            {
+                return score;
+            }
+
+        private:
+            static double unreached() noexcept
+            {
+                return std::numeric_limits<double>::infinity();
+            }
+            double length(std::size_t entry) const
+            {
+                return weights == nullptr ? 1 : (*weights)[entry];
+            }
+
+            void breadth_first(index_t s)
+            {
+                sigma[s] = 1;
+                distance[s] = 0;
+                order.push_back(s);
+                for (std::size_t head = 0; head != order.size(); ++head)
+                {
+                    index_t w = order[head];
+                    for (index_t v : g.neighbors(w))
+                    {
+                        if (distance[v] == unreached())
+                        {
+                            distance[v] = distance[w] + 1;
+                            order.push_back(v);
+                        }
+                        if (distance[v] == distance[w] + 1)
+                            sigma[v] += sigma[w];
+                    }
+                }
+            }
+            void dijkstra(index_t s)        //order为按距离确定的先后顺序
+            {
+                using entry = std::pair<double, index_t>;
+                std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+                sigma[s] = 1;
+                distance[s] = 0;
+                heap.emplace(0, s);
+                while (!heap.empty())
+                {
+                    entry top = heap.top();
+                    heap.pop();
+                    index_t w = top.second;
+                    if (top.first > distance[w])
+                        continue;               //过时的条目;每个顶点以最终距离入堆恰好一次
+                    order.push_back(w);
+                    std::size_t const first = g.offset(w);
+                    auto neighbors = g.neighbors(w);
+                    for (std::size_t j = 0; j != neighbors.size(); ++j)
+                    {
+                        index_t v = neighbors[j];
+                        double const d = distance[w] + (*weights)[first + j];
+                        if (d < distance[v])
+                        {
+                            distance[v] = d;
+                            sigma[v] = sigma[w];
+                            heap.emplace(d, v);
+                        }
+                        else if (d == distance[v] && !(v == w))
+                            sigma[v] += sigma[w];
+                    }
+                }
+            }
+            csr_graph const& g;
+            std::vector<double> const* weights;
+            std::vector<double> score;
+            std::vector<double> sigma;
+            std::vector<double> distance;
+            std::vector<double> delta;
+            std::vector<index_t> order;
+        };
+
+        inline std::vector<double> brandes(csr_graph const& g, std::vector<double> const* weights,
+                                           std::vector<csr_graph::index_t> const& sources, double scale, std::size_t threads)
+        {
+            if (threads == 0)
+                threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            threads = std::max<std::size_t>(1, std::min(threads, sources.size()));
+            std::vector<brandes_worker> workers(threads, brandes_worker(g, weights));
+            std::atomic<std::size_t> next{0};
+            auto work = [&](brandes_worker& worker)
+            {
+                for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < sources.size();)
+                    worker.accumulate(sources[i], scale);
+            };
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < threads; ++t)
+                pool.emplace_back(work, std::ref(workers[t]));
+            work(workers[0]);
+            for (auto& t : pool)
+                t.join();
+
+            std::vector<double> ret(g.vertex_count(), 0);
+            double const pairs = g.is_directed() ? 1 : 0.5;     //无向图中s->t与t->s是同一对
+            for (auto const& worker : workers)
+                for (std::size_t v = 0; v != ret.size(); ++v)
+                    ret[v] += pairs * worker.result()[v];
+            return ret;
+        }
+    }
+
+    //精确值,threads为0时使用std::thread::hardware_concurrency()个线程
+    inline std::vector<double> betweenness_centrality(csr_graph const& g, std::size_t threads = 0)
+    {
+        std::vector<csr_graph::index_t> sources(g.vertex_count());
+        for (csr_graph::index_t v = 0; v != sources.size(); ++v)
+            sources[v] = v;
+        return detail::brandes(g, nullptr, sources, 1, threads);
+    }
+
+    /*
+     * 带权的精确值.csr须由g构造,weight(g.value(e))给出边e的长度,须为正数.
+     * 最短路径按长度是否相等判断,长度为整数(或可精确表示)时结果最可靠.
+     */
+    template<class GraphT, class WeightF>
+    std::vector<double> betweenness_centrality(GraphT const& g, csr_graph const& csr, WeightF weight, std::size_t threads = 0)
+    {
+        std::vector<double> weights(csr.entry_count());
+        for (csr_graph::index_t v = 0; v != csr.vertex_count(); ++v)
+        {
+            auto edges = csr.edge_indices(v);
+            for (std::size_t j = 0; j != edges.size(); ++j)
+                weights[csr.offset(v) + j] = static_cast<double>(weight(g.value(detail::id_access::make_edge_id(edges[j]))));
+        }
+        std::vector<csr_graph::index_t> sources(csr.vertex_count());
+        for (csr_graph::index_t v = 0; v != sources.size(); ++v)
+            sources[v] = v;
+        return detail::brandes(csr, &weights, sources, 1, threads);
+    }
+
+    //估计值所需的源点数:归一化(除以(n-1)(n-2))后所有顶点的误差都不超过epsilon的概率至少为1-delta(Hoeffding界)
+    //precondition: epsilon > 0, 0 < delta < 1.结果超出std::size_t的范围时为其最大值
+    inline std::size_t betweenness_sample_size(std::size_t vertex_count, double epsilon, double delta)
+    {
+        assert(epsilon > 0 && delta > 0 && delta < 1);
+        if (vertex_count == 0)
+            return 0;
+        double const k = std::ceil(std::log(2.0 * static_cast<double>(vertex_count) / delta) / (2 * epsilon * epsilon));
+        if (!(k < static_cast<double>(std::numeric_limits<std::size_t>::max())))     //含NaN
+            return std::numeric_limits<std::size_t>::max();
+        return static_cast<std::size_t>(k);
+    }
+
+    //随机抽取betweenness_sample_size个源点(可重复),按n/k放大后作为估计值.样本数不少于n时直接计算精确值
+    inline std::vector<double> approximate_betweenness_centrality(csr_graph const& g, double epsilon, double delta,
+                                                                  std::uint64_t seed = 0, std::size_t threads = 0)
+    {
+        std::size_t const n = g.vertex_count();
+        std::size_t const k = betweenness_sample_size(n, epsilon, delta);
+        if (k >= n)
+            return betweenness_centrality(g, threads);
+        std::mt19937_64 random(seed);
+        std::uniform_int_distribution<csr_graph::index_t> pick(0, static_cast<csr_graph::index_t>(n - 1));
+        std::vector<csr_graph::index_t> sources(k);
+        for (auto& s : sources)
+            s = pick(random);
+        return detail::brandes(g, nullptr, sources, static_cast<double>(n) / static_cast<double>(k), threads);
+    }
+}
+
+#endif //GRAPH_BETWEENNESS_H
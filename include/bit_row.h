@@ -0,0 +1,82 @@
+#ifndef GRAPH_BIT_ROW_H
+#define GRAPH_BIT_ROW_H
+
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        inline unsigned popcount(std::uint64_t x) noexcept
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_popcountll(x));
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ull);
+            x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+            x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+            return static_cast<unsigned>((x * 0x0101010101010101ull) >> 56);
+#endif
+        }
+        inline unsigned lowest_bit(std::uint64_t x) noexcept    //precondition: x != 0
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(x));
+#else
+            return popcount((x & (0 - x)) - 1);
+#endif
+        }
+        template<class F>
+        void for_each_bit(std::uint64_t const* words, std::size_t word_count, F f)  //按升序对每个置位的下标调用f
+        {
+            for (std::size_t w = 0; w != word_count; ++w)
+                for (std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+                    f(w * 64 + lowest_bit(bits));
+        }
+    }
+
+    /*
+     * 只读的一行位(如邻接矩阵的一行),按64位字访问.
+     * 对两行逐字做与/或运算的循环可被编译器向量化.
+     */
+    class bit_row
+    {
+    public:
+        bit_row(std::uint64_t const* words, std::size_t word_count) noexcept
+            : words(words), word_count_(word_count)
+        {}
+
+        bool test(std::size_t i) const noexcept
+        {
+            return (words[i / 64] >> (i % 64)) & 1;
+        }
+        std::size_t count() const noexcept
+        {
+            std::size_t ret = 0;
+            for (std::size_t w = 0; w != word_count_; ++w)
+                ret += detail::popcount(words[w]);
+            return ret;
+        }
+        template<class F>
+        void for_each(F f) const
+        {
+            detail::for_each_bit(words, word_count_, f);
+        }
+
+        std::uint64_t const* data() const noexcept
+        {
+            return words;
+        }
+        std::size_t word_count() const noexcept
+        {
+            return word_count_;
+        }
+
+    private:
+        std::uint64_t const* words;
+        std::size_t word_count_;
+    };
+}
+
+#endif //GRAPH_BIT_ROW_H
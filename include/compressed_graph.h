@@ -0,0 +1,438 @@
+#ifndef GRAPH_COMPRESSED_GRAPH_H
+#define GRAPH_COMPRESSED_GRAPH_H
+
+#include <algorithm>  //for std::sort
+#include <cstddef>    //for std::size_t, std::ptrdiff_t
+#include <cstdint>    //for std::uint8_t, std::uint64_t
+#include <cstring>    //for std::memcpy
+#include <iterator>   //for std::forward_iterator_tag
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/vertex.h"
+
+/** \file
+ *  \brief 压缩的只读图.
+ *
+ * 每个顶点的邻居(与csr_graph相同:稠密编号,升序)编码为一段字节流:
+ * 度数,首个邻居相对于顶点自身编号的差(zigzag),以及此后相邻两个邻居之差,均为LEB128 varint.
+ * 经过reorder.h中的重排后差值大多小于128,每个邻接项约占1~2字节.
+ * 遍历时逐项解码;decode_neighbors()一次检查8个字节,全部为单字节varint时整字解码.
+ * 此外每个顶点有一个8字节的偏移,一个vertex_id与一个反向映射项,见encoded_bytes().
+ * 不保存边的index与值,只用于拓扑遍历.
+ * 另提供图的只读遍历接口(first_vertex/next_vertex,associated_edges,index,vertex_index_bound),
+ * traversal.h中的遍历可以直接作用于compressed_graph;其中index(v)为稠密编号,
+ * edge_ref的edge()由两端的稠密编号合成(原图的边未被保存),只用于区分不同的边,平行边共享同一个标识.
+ */
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        inline void put_varint(std::vector<std::uint8_t>& out, std::uint64_t x)
+        {
+            while (x >= 0x80)
+            {
+                out.push_back(static_cast<std::uint8_t>(x | 0x80));
+                x >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(x));
+        }
+        inline std::uint64_t get_varint(std::uint8_t const*& p) noexcept
+        {
+            std::uint64_t ret = *p & 0x7f;
+            for (unsigned shift = 7; *p++ & 0x80; shift += 7)
+                ret |= static_cast<std::uint64_t>(*p & 0x7f) << shift;
+            return ret;
+        }
+        inline std::uint64_t zigzag(std::int64_t x) noexcept
+        {
+            return (static_cast<std::uint64_t>(x) << 1) ^ static_cast<std::uint64_t>(x >> 63);
+        }
+        inline std::int64_t unzigzag(std::uint64_t x) noexcept
+        {
+            return static_cast<std::int64_t>(x >> 1) ^ -static_cast<std::int64_t>(x & 1);
+        }
+    }
+
+    class compressed_graph
+    {
+    public:
+        using index_t = csr_graph::index_t;
+
+        class neighbor_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = index_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = index_t const*;
+            using reference = index_t;
+
+            neighbor_iterator() = default;
+            neighbor_iterator(std::uint8_t const* p, std::size_t left, index_t v)
+                : p(p), left(left), current(v)
+            {
+                if (left != 0)
+                    current = static_cast<index_t>(v + detail::unzigzag(detail::get_varint(this->p)));
+            }
+
+            index_t operator*() const noexcept
+            {
+                return current;
+            }
+            neighbor_iterator& operator++() noexcept
+            {
+                if (--left != 0)
+                    current += static_cast<index_t>(detail::get_varint(p));
+                return *this;
+            }
+            neighbor_iterator operator++(int) noexcept
+            {
+                neighbor_iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(neighbor_iterator const& rhs) const noexcept    //只比较剩余项数,只应比较同一顶点的迭代器
+            {
+                return left == rhs.left;
+            }
+            bool operator!=(neighbor_iterator const& rhs) const noexcept
+            {
+                return !(*this == rhs);
+            }
+
+        private:
+            std::uint8_t const* p = nullptr;
+            std::size_t left = 0;
+            index_t current = 0;
+        };
+
+        class neighbor_range
+        {
+        public:
+            neighbor_range(neighbor_iterator first, std::size_t size)
+                : first(first), count(size)
+            {}
+            neighbor_iterator begin() const noexcept
+            {
+                return first;
+            }
+            neighbor_iterator end() const noexcept
+            {
+                return {};
+            }
+            std::size_t size() const noexcept
+            {
+                return count;
+            }
+            bool empty() const noexcept
+            {
+                return count == 0;
+            }
+
+        private:
+            neighbor_iterator first;
+            std::size_t count;
+        };
+
+        class edge_iterator        //把稠密编号的邻居还原为edge_ref
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = detail::edge_ref;
+            using difference_type = std::ptrdiff_t;
+            using pointer = detail::edge_ref const*;
+            using reference = detail::edge_ref const&;
+
+            edge_iterator(compressed_graph const* g, index_t from, neighbor_iterator i)
+                : g(g), from(from), i(i),
+                  current(detail::id_access::make_edge_id(0), detail::id_access::make_vertex_id(0))
+            {}
+
+            reference operator*() const
+            {
+                current = g->make_edge_ref(from, *i);
+                return current;
+            }
+            pointer operator->() const
+            {
+                return &**this;
+            }
+            edge_iterator& operator++() noexcept
+            {
+                ++i;
+                return *this;
+            }
+            edge_iterator operator++(int) noexcept
+            {
+                edge_iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(edge_iterator const& rhs) const noexcept
+            {
+                return i == rhs.i;
+            }
+            bool operator!=(edge_iterator const& rhs) const noexcept
+            {
+                return i != rhs.i;
+            }
+
+        private:
+            compressed_graph const* g;
+            index_t from;
+            neighbor_iterator i;
+            mutable detail::edge_ref current;
+        };
+
+        class edge_range
+        {
+        public:
+            edge_range(compressed_graph const* g, index_t from, neighbor_range neighbors)
+                : g(g), from(from), neighbors(neighbors)
+            {}
+            edge_iterator begin() const noexcept
+            {
+                return {g, from, neighbors.begin()};
+            }
+            edge_iterator end() const noexcept
+            {
+                return {g, from, neighbors.end()};
+            }
+            std::size_t size() const noexcept
+            {
+                return neighbors.size();
+            }
+            bool empty() const noexcept
+            {
+                return neighbors.empty();
+            }
+
+        private:
+            compressed_graph const* g;
+            index_t from;
+            neighbor_range neighbors;
+        };
+
+        compressed_graph() = default;
+
+        explicit compressed_graph(csr_graph const& g)
+            : directed(g.is_directed()), entries(g.entry_count())
+        {
+            std::size_t const n = g.vertex_count();
+            offsets.reserve(n + 1);
+            vertices.reserve(n);
+            to_dense.assign(to_dense_size(g), index_t(csr_graph::npos));
+            for (index_t v = 0; v != n; ++v)
+            {
+                vertices.push_back(g.vertex(v));
+                to_dense[detail::id_access::to_stock_id(g.vertex(v)).id()] = v;
+                append(v, g.neighbors(v).begin(), g.neighbors(v).end());
+            }
+            finish();
+        }
+
+        //直接从图构造,不经过csr_graph,峰值内存只多出一个顶点的邻居
+        template<class GraphT>
+        explicit compressed_graph(GraphT const& g)
+            : directed(GraphT::is_directed)
+        {
+            index_t const npos = csr_graph::npos;
+            to_dense.assign(g.vertex_index_bound(), npos);
+            vertices.reserve(g.vertex_count());
+            offsets.reserve(g.vertex_count() + 1);
+            for (auto v = g.first_vertex(); !g.vertex_end(v); v = g.next_vertex(v))
+            {
+                to_dense[g.index(v)] = static_cast<index_t>(vertices.size());
+                vertices.push_back(v);
+            }
+            std::vector<index_t> row;
+            for (index_t v = 0; v != vertices.size(); ++v)
+            {
+                row.clear();
+                for (auto e : g.associated_edges(vertices[v]))
+                    row.push_back(to_dense[g.index(e.opposite_vertex())]);
+                std::sort(row.begin(), row.end());
+                entries += row.size();
+                append(v, row.begin(), row.end());
+            }
+            finish();
+        }
+
+        std::size_t vertex_count() const noexcept
+        {
+            return vertices.size();
+        }
+        std::size_t entry_count() const noexcept
+        {
+            return entries;
+        }
+        bool is_directed() const noexcept
+        {
+            return directed;
+        }
+
+        std::size_t degree(index_t v) const noexcept
+        {
+            std::uint8_t const* p = bytes.data() + offsets[v];
+            return detail::get_varint(p);
+        }
+        neighbor_range neighbors(index_t v) const noexcept    //升序
+        {
+            std::uint8_t const* p = bytes.data() + offsets[v];
+            std::size_t d = detail::get_varint(p);
+            return {neighbor_iterator(p, d, v), d};
+        }
+        template<class F>
+        void for_each_neighbor(index_t v, F f) const
+        {
+            for (index_t u : neighbors(v))
+                f(u);
+        }
+        bool adjacent(index_t x, index_t y) const noexcept
+        {
+            for (index_t u : neighbors(x))
+                if (u >= y)
+                    return u == y;
+            return false;
+        }
+        //把v的邻居追加到out中.连续8个单字节的差值一次解码
+        void decode_neighbors(index_t v, std::vector<index_t>& out) const
+        {
+            std::uint8_t const* p = bytes.data() + offsets[v];
+            std::size_t left = detail::get_varint(p);
+            if (left == 0)
+                return;
+            index_t current = static_cast<index_t>(v + detail::unzigzag(detail::get_varint(p)));
+            out.push_back(current);
+            --left;
+            while (left >= 8)
+            {
+                std::uint64_t word;
+                std::memcpy(&word, p, 8);       //bytes末尾有8字节的填充,不会越界
+                if ((word & 0x8080808080808080ull) == 0)
+                {
+                    for (unsigned k = 0; k != 8; ++k)
+                    {
+                        current += p[k];      //与字节序无关
+                        out.push_back(current);
+                    }
+                    p += 8;
+                    left -= 8;
+                }
+                else
+                {
+                    current += static_cast<index_t>(detail::get_varint(p));
+                    out.push_back(current);
+                    --left;
+                }
+            }
+            for (; left != 0; --left)
+            {
+                current += static_cast<index_t>(detail::get_varint(p));
+                out.push_back(current);
+            }
+        }
+
+        vertex_id vertex(index_t v) const
+        {
+            return vertices[v];
+        }
+        index_t dense_index(vertex_id v) const
+        {
+            return to_dense[detail::id_access::to_stock_id(v).id()];
+        }
+
+        //图的只读遍历接口,按稠密编号的顺序遍历顶点
+        vertex_id first_vertex() const
+        {
+            return vertices.empty() ? vertex_sentinel() : vertices.front();
+        }
+        bool vertex_end(vertex_id v) const
+        {
+            return detail::id_access::to_stock_id(v).id() >= to_dense.size();
+        }
+        vertex_id next_vertex(vertex_id v) const
+        {
+            std::size_t const next = dense_index(v) + std::size_t(1);
+            return next == vertices.size() ? vertex_sentinel() : vertices[next];
+        }
+        edge_range associated_edges(vertex_id v) const     //按相邻顶点的稠密编号升序
+        {
+            index_t const x = dense_index(v);
+            return {this, x, neighbors(x)};
+        }
+        std::size_t index(vertex_id v) const
+        {
+            return dense_index(v);
+        }
+        std::size_t vertex_index_bound() const noexcept
+        {
+            return vertex_count();
+        }
+
+        std::size_t encoded_bytes() const noexcept     //邻居编码,每个顶点的偏移,vertex_id表与反向映射的字节数(不含填充与空余容量)
+        {
+            return bytes.size() - padding + offsets.size() * sizeof(std::size_t)
+                   + vertices.size() * sizeof(vertex_id) + to_dense.size() * sizeof(index_t);
+        }
+        std::size_t memory_usage() const noexcept      //包括每个顶点的偏移与id映射
+        {
+            return bytes.capacity() + offsets.capacity() * sizeof(std::size_t)
+                   + vertices.capacity() * sizeof(vertex_id) + to_dense.capacity() * sizeof(index_t);
+        }
+
+    private:
+        static constexpr std::size_t padding = 8;
+
+        vertex_id vertex_sentinel() const       //vertex_end()为true的id
+        {
+            return detail::id_access::make_vertex_id(to_dense.size());
+        }
+        detail::edge_ref make_edge_ref(index_t x, index_t y) const
+        {
+            std::size_t const n = vertex_count();
+            std::size_t const key = directed || x <= y ? std::size_t(x) * n + y : std::size_t(y) * n + x;
+            return {detail::id_access::make_edge_id(key), vertices[y]};
+        }
+
+        static std::size_t to_dense_size(csr_graph const& g)
+        {
+            std::size_t ret = 0;
+            for (index_t v = 0; v != g.vertex_count(); ++v)
+                ret = std::max<std::size_t>(ret, detail::id_access::to_stock_id(g.vertex(v)).id() + 1);
+            return ret;
+        }
+
+        template<class InputIt>
+        void append(index_t v, InputIt first, InputIt last)
+        {
+            offsets.push_back(bytes.size());
+            detail::put_varint(bytes, static_cast<std::uint64_t>(std::distance(first, last)));
+            if (first == last)
+                return;
+            index_t previous = *first;
+            detail::put_varint(bytes, detail::zigzag(static_cast<std::int64_t>(previous) - static_cast<std::int64_t>(v)));
+            for (++first; first != last; ++first)
+            {
+                detail::put_varint(bytes, *first - previous);
+                previous = *first;
+            }
+        }
+        void finish()
+        {
+            offsets.push_back(bytes.size());
+            bytes.resize(bytes.size() + padding, 0);
+            bytes.shrink_to_fit();
+        }
+
+        bool directed = false;
+        std::size_t entries = 0;
+        std::vector<std::uint8_t> bytes;
+        std::vector<std::size_t> offsets;
+        std::vector<vertex_id> vertices;
+        std::vector<index_t> to_dense;
+    };
+}
+
+#endif //GRAPH_COMPRESSED_GRAPH_H
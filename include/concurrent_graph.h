@@ -0,0 +1,163 @@
+#ifndef GRAPH_CONCURRENT_GRAPH_H
+#define GRAPH_CONCURRENT_GRAPH_H
+
+#include <atomic>     //for std::atomic
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <utility>    //for std::pair, std::forward
+#include <vector>     //for std::vector
+#include "Graph/include/persistent_graph.h"
+#include "Graph/include/epoch.h"
+
+/** \file
+ *  \brief 一个写者,多个读者的无向图.
+ *
+ * 写者(同一时刻只能有一个线程)像使用undirected_graph一样修改图,修改先作用于写者私有的工作副本,
+ * 调用publish()后才作为一个新版本整体对读者可见.
+ * 读者通过read()得到某个已发布版本的只读快照,期间不加锁,也不会被写者阻塞;
+ * 工作副本是一个persistent_undirected_graph,发布一个版本只是O(1)地复制它;
+ * 各版本以分块写时复制的方式共享顶点/边,旧版本在没有读者引用后经epoch回收释放.
+ */
+
+namespace lzhlib
+{
+    template<class VertexValueT, class EdgeValueT>
+    class concurrent_undirected_graph
+    {
+    public:
+        using snapshot_t = graph_snapshot<VertexValueT, EdgeValueT>;
+        using vertex_value_t = typename snapshot_t::vertex_value_t;
+        using edge_value_t = typename snapshot_t::edge_value_t;
+        using edge_ref_t = typename snapshot_t::edge_ref_t;
+        using pair_t = typename snapshot_t::pair_t;
+
+        class read_view          //在其生存期内,所指的快照不会被回收.应尽快销毁,以免推迟旧版本的回收
+        {
+            friend class concurrent_undirected_graph;
+
+        public:
+            read_view(read_view&& other) noexcept
+                : epochs(other.epochs), slot(other.slot), snapshot(other.snapshot)
+            {
+                other.epochs = nullptr;
+            }
+            read_view(read_view const&) = delete;
+            read_view& operator=(read_view const&) = delete;
+            read_view& operator=(read_view&&) = delete;
+            ~read_view()
+            {
+                if (epochs != nullptr)
+                    epochs->leave(slot);
+            }
+
+            snapshot_t const& operator*() const noexcept
+            {
+                return *snapshot;
+            }
+            snapshot_t const* operator->() const noexcept
+            {
+                return snapshot;
+            }
+
+        private:
+            read_view(detail::epoch_manager& e, std::atomic<snapshot_t const*> const& published)
+                : epochs(&e), slot(e.enter()), snapshot(published.load(std::memory_order_seq_cst))
+            {}
+
+            detail::epoch_manager* epochs;
+            std::size_t slot;
+            snapshot_t const* snapshot;
+        };
+
+        concurrent_undirected_graph()
+            : published(new snapshot_t(working_))
+        {}
+        concurrent_undirected_graph(concurrent_undirected_graph const&) = delete;
+        concurrent_undirected_graph& operator=(concurrent_undirected_graph const&) = delete;
+        ~concurrent_undirected_graph()    //precondition: no read_view is alive
+        {
+            delete published.load();
+            for (auto const& r : retired)
+                delete r.second;
+        }
+
+        //reader side, callable from any thread
+        read_view read() const
+        {
+            return read_view(epochs, published);
+        }
+
+        //writer side, one thread at a time
+        template<class ...Args>
+        vertex_id add_vertex(Args&& ...args)
+        {
+            return working_.add_vertex(std::forward<Args>(args)...);
+        }
+        void remove_vertex(vertex_id v)
+        {
+            working_.remove_vertex(v);
+        }
+
+        template<class ...Args>
+        edge_id add_edge(vertex_id x, vertex_id y, Args&& ...args)
+        {
+            return working_.add_edge(x, y, std::forward<Args>(args)...);
+        }
+        void remove_edge(vertex_id x, vertex_id y)
+        {
+            working_.remove_edge(x, y);
+        }
+        void remove_edge(edge_id e)
+        {
+            working_.remove_edge(e);
+        }
+
+        vertex_value_t& value(vertex_id v)
+        {
+            return working_.value(v);
+        }
+        edge_value_t& value(edge_id e)
+        {
+            return working_.value(e);
+        }
+
+        snapshot_t const& working() const noexcept   //写者自己的(可能尚未发布的)视图
+        {
+            return working_;
+        }
+
+        std::uint64_t publish()    //原子地使上次publish以来的所有修改对读者可见,返回新版本号
+        {
+            ++working_.version_;
+            snapshot_t const* next = new snapshot_t(working_);
+            snapshot_t const* old = published.exchange(next, std::memory_order_seq_cst);
+            retired.emplace_back(epochs.retire_epoch(), old);
+            reclaim();
+            return next->version();
+        }
+        std::size_t pending_reclamations() const noexcept
+        {
+            return retired.size();
+        }
+        void reclaim()             //释放已没有读者引用的旧版本;publish会自动调用
+        {
+            auto keep = retired.begin();
+            for (auto i = retired.begin(); i != retired.end(); ++i)
+            {
+                if (epochs.safe_to_reclaim(i->first))
+                    delete i->second;
+                else
+                    *keep++ = *i;
+            }
+            retired.erase(keep, retired.end());
+        }
+
+    private:
+        persistent_undirected_graph<VertexValueT, EdgeValueT> working_;
+        std::atomic<snapshot_t const*> published;
+        mutable detail::epoch_manager epochs;
+        std::vector<std::pair<std::uint64_t, snapshot_t const*>> retired;
+    };
+}
+
+#endif //GRAPH_CONCURRENT_GRAPH_H
@@ -0,0 +1,143 @@
+#ifndef GRAPH_CSR_GRAPH_H
+#define GRAPH_CSR_GRAPH_H
+
+#include <algorithm>  //for std::sort
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint32_t
+#include <utility>    //for std::pair
+#include <vector>     //for std::vector
+#include "Graph/include/id_access.h"
+#include "Graph/include/value_column.h"
+
+/** \file
+ *  \brief 图的拓扑结构的只读快照(Compressed Sparse Row).
+ *
+ * 顶点被重新编号为连续的[0,vertex_count()),每个顶点的邻居(有向图为出边的终点,无向图为所有相邻顶点)
+ * 按升序存放在一个连续数组中,供遍历类算法使用.
+ * 每个邻接项同时记录对应边在原图中的index,以便通过原图取得边的值.快照不随原图的修改而更新.
+ */
+
+namespace lzhlib
+{
+    class csr_graph
+    {
+    public:
+        using index_t = std::uint32_t;
+        static constexpr index_t npos = static_cast<index_t>(-1);
+
+        csr_graph() = default;
+
+        template<class GraphT>
+        explicit csr_graph(GraphT const& g)
+            : directed(GraphT::is_directed)
+        {
+            to_dense.assign(g.vertex_index_bound(), index_t(npos));
+            vertices.reserve(g.vertex_count());
+            for (auto v = g.first_vertex(); !g.vertex_end(v); v = g.next_vertex(v))
+            {
+                to_dense[g.index(v)] = static_cast<index_t>(vertices.size());
+                vertices.push_back(v);
+            }
+            offsets.reserve(vertices.size() + 1);
+            offsets.push_back(0);
+            std::vector<std::pair<index_t, std::size_t>> row;
+            for (vertex_id v : vertices)
+            {
+                row.clear();
+                for (auto e : g.associated_edges(v))
+                    row.emplace_back(to_dense[g.index(e.opposite_vertex())], g.index(e.edge()));
+                std::sort(row.begin(), row.end());
+                for (auto const& r : row)
+                {
+                    targets.push_back(r.first);
+                    edges.push_back(r.second);
+                }
+                offsets.push_back(targets.size());
+            }
+        }
+
+        std::size_t vertex_count() const noexcept
+        {
+            return vertices.size();
+        }
+        std::size_t entry_count() const noexcept    //邻接项的总数;无向图中每条(非自环)边出现两次
+        {
+            return targets.size();
+        }
+        bool is_directed() const noexcept
+        {
+            return directed;
+        }
+
+        std::size_t degree(index_t v) const
+        {
+            return offsets[v + 1] - offsets[v];
+        }
+        column_span<index_t const> neighbors(index_t v) const   //升序
+        {
+            return {targets.data() + offsets[v], degree(v)};
+        }
+        column_span<std::size_t const> edge_indices(index_t v) const  //与neighbors(v)一一对应的原图中边的index
+        {
+            return {edges.data() + offsets[v], degree(v)};
+        }
+        std::size_t offset(index_t v) const     //neighbors(v)在所有邻接项中的起始位置
+        {
+            return offsets[v];
+        }
+
+        vertex_id vertex(index_t v) const       //稠密编号 -> 原图中的vertex_id
+        {
+            return vertices[v];
+        }
+        index_t dense_index(vertex_id v) const  //原图中的vertex_id -> 稠密编号
+        {
+            return to_dense[detail::id_access::to_stock_id(v).id()];
+        }
+
+        //按new_index(旧稠密编号 -> 新稠密编号,须为一个排列)重新编号后的快照
+        csr_graph permuted(std::vector<index_t> const& new_index) const
+        {
+            csr_graph ret;
+            ret.directed = directed;
+            std::size_t const n = vertex_count();
+            std::vector<index_t> old_index(n);
+            for (index_t v = 0; v != n; ++v)
+                old_index[new_index[v]] = v;
+            ret.vertices.resize(n);
+            ret.to_dense.assign(to_dense.size(), index_t(npos));
+            ret.offsets.reserve(n + 1);
+            ret.offsets.push_back(0);
+            ret.targets.reserve(targets.size());
+            ret.edges.reserve(edges.size());
+            std::vector<std::pair<index_t, std::size_t>> row;
+            for (index_t nv = 0; nv != n; ++nv)
+            {
+                index_t ov = old_index[nv];
+                ret.vertices[nv] = vertices[ov];
+                ret.to_dense[detail::id_access::to_stock_id(vertices[ov]).id()] = nv;
+                row.clear();
+                for (std::size_t k = offsets[ov]; k != offsets[ov + 1]; ++k)
+                    row.emplace_back(new_index[targets[k]], edges[k]);
+                std::sort(row.begin(), row.end());
+                for (auto const& r : row)
+                {
+                    ret.targets.push_back(r.first);
+                    ret.edges.push_back(r.second);
+                }
+                ret.offsets.push_back(ret.targets.size());
+            }
+            return ret;
+        }
+
+    private:
+        bool directed = false;
+        std::vector<std::size_t> offsets;
+        std::vector<index_t> targets;
+        std::vector<std::size_t> edges;
+        std::vector<vertex_id> vertices;
+        std::vector<index_t> to_dense;
+    };
+}
+
+#endif //GRAPH_CSR_GRAPH_H
@@ -6,9 +6,15 @@
 
 namespace lzhlib
 {
+    namespace detail
+    {
+        struct id_access;
+    }
+
     class edge_id
     {
-        template<class, class>
+        friend struct detail::id_access;
+        template<class, class, class>
         friend
         class graph_base;
 
@@ -0,0 +1,78 @@
+#ifndef GRAPH_EPOCH_H
+#define GRAPH_EPOCH_H
+
+#include <array>      //for std::array
+#include <atomic>     //for std::atomic
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <functional> //for std::hash
+#include <thread>     //for std::this_thread
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        /*
+         * 基于epoch的内存回收.
+         * 读者在访问共享对象前进入(enter)并公布自己看到的全局epoch,结束后离开(leave);
+         * 写者把对象从共享位置摘下后调用retire_epoch()得到该对象的退休epoch e,
+         * 当safe_to_reclaim(e)为true时,再没有读者可能持有它,可以释放.
+         * 读者与写者都不加锁:读者只做一次CAS占用槽位和两次store.
+         */
+        class epoch_manager
+        {
+        public:
+            static constexpr std::size_t max_readers = 128;  //同时处于临界区的读者上限;超出时enter会自旋等待
+
+            epoch_manager() = default;
+            epoch_manager(epoch_manager const&) = delete;
+            epoch_manager& operator=(epoch_manager const&) = delete;
+
+            std::size_t enter()
+            {
+                std::size_t i = std::hash<std::thread::id>()(std::this_thread::get_id()) % max_readers;
+                for (;; i = (i + 1) % max_readers)
+                {
+                    bool expected = false;
+                    if (!slots[i].in_use.load(std::memory_order_relaxed) &&
+                        slots[i].in_use.compare_exchange_weak(expected, true, std::memory_order_acquire))
+                        break;
+                }
+                slots[i].epoch.store(global.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+                return i;
+            }
+            void leave(std::size_t slot) noexcept
+            {
+                slots[slot].epoch.store(0, std::memory_order_release);
+                slots[slot].in_use.store(false, std::memory_order_release);
+            }
+
+            std::uint64_t retire_epoch() noexcept   //call after the retired object has been unlinked
+            {
+                return global.fetch_add(1, std::memory_order_seq_cst);
+            }
+            bool safe_to_reclaim(std::uint64_t retired) const noexcept
+            {
+                for (auto const& s : slots)
+                {
+                    std::uint64_t e = s.epoch.load(std::memory_order_seq_cst);
+                    if (e != 0 && e <= retired)
+                        return false;
+                }
+                return true;
+            }
+
+        private:
+            struct alignas(64) slot
+            {
+                std::atomic<std::uint64_t> epoch{0};   //0 means the slot is not inside a critical section
+                std::atomic<bool> in_use{false};
+            };
+
+            std::atomic<std::uint64_t> global{1};
+            std::array<slot, max_readers> slots;
+        };
+    }
+}
+
+#endif //GRAPH_EPOCH_H
@@ -3,6 +3,7 @@
 
 #include "Graph/include/undirected_graph.h"
 #include "Graph/include/directed_graph.h"
+#include "Graph/include/arena.h"
 /** \file
  *  \brief 本文件提供与 [图](https://en.wikipedia.org/wiki/Graph_(abstract_data_type)) 有关的抽象.
  *
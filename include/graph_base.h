@@ -1,22 +1,90 @@
 #ifndef GRAPH_GRAPH_BASE_H
 #define GRAPH_GRAPH_BASE_H
 
+#include <algorithm>      //for std::sort, std::unique, std::binary_search
+#include <cassert>        //for assert
+#include <cstddef>        //for std::size_t
+#include <utility>        //for std::pair
+#include <vector>         //for std::vector
+#include <memory>         //for std::allocator, std::allocator_traits
+#include <type_traits>    //for std::integral_constant, std::conditional_t
 #include "Graph/include/vertex.h"
 #include "Graph/include/edge.h"
 #include "Graph/include/repository.h"
+#include "Graph/include/inline_repository.h"
+#include "Graph/include/value_column.h"
+#include "Graph/include/id_remap.h"
 
 namespace lzhlib
 {
-    template<class VertexValueT, class EdgeValueT>
+    struct graph_memory_usage      //单位为字节.值与邻接集合按浅层大小估算,不追踪值内部的动态内存
+    {
+        std::size_t vertex_store = 0;   //vertex slots + vertex objects (without their values)
+        std::size_t edge_store = 0;     //edge slots + edge objects (without their values)
+        std::size_t adjacency = 0;      //std::set nodes holding edge_refs
+        std::size_t values = 0;         //vertex values + edge values
+        std::size_t key_index = 0;      //keyed_graph的键索引
+
+        std::size_t total() const noexcept
+        {
+            return vertex_store + edge_store + adjacency + values + key_index;
+        }
+    };
+
+    namespace detail
+    {
+        template<class ValueT>
+        struct value_footprint : std::integral_constant<std::size_t, sizeof(ValueT)>
+        {
+        };
+        template<>
+        struct value_footprint<null_value_tag> : std::integral_constant<std::size_t, 0>
+        {
+        };
+
+        //a red-black tree node carries a colour and three links in front of its value
+        constexpr std::size_t set_node_overhead = 4 * sizeof(void*);
+
+        //edge<null_value_tag>只有一对端点,无需逐个分配,直接放在连续数组中
+        template<class EdgeT, class AllocatorT>
+        using edge_repository_for = std::conditional_t<std::is_same<typename EdgeT::edge_value_t, null_value_tag>::value,
+                                                       inline_repository<EdgeT, AllocatorT>,
+                                                       repository<EdgeT, AllocatorT>>;
+    }
+
+    template<class GraphT>
+    class concurrent_graph_builder;
+
+    template<class VertexValueT, class EdgeValueT, class AllocatorT = std::allocator<char>>
     class graph_base
     {
+        template<class>
+        friend
+        class concurrent_graph_builder;
+
     public:
-        using vertex_t = detail::vertex<VertexValueT>;
-        using vertex_value_t = typename vertex_t::vertex_value_t;
+        using allocator_t = AllocatorT;
+        using vertex_layout_t = detail::value_layout<VertexValueT>;
+        using edge_layout_t = detail::value_layout<EdgeValueT>;
+        using vertex_t = detail::vertex<typename vertex_layout_t::stored_t, allocator_t>;
+        using vertex_value_t = typename vertex_layout_t::value_t;
         using edge_ref_t = typename detail::edge_ref;
-        using edge_t = detail::edge<EdgeValueT>;
-        using edge_value_t = typename edge_t::edge_value_t;
+        using edge_t = detail::edge<typename edge_layout_t::stored_t>;
+        using edge_value_t = typename edge_layout_t::value_t;
         using pair_t = typename edge_t::pair_t;
+        using vertex_repository_t = repository<vertex_t, allocator_t>;
+        using edge_repository_t = detail::edge_repository_for<edge_t, allocator_t>;
+        using vertex_column_t = detail::value_column_for<VertexValueT, allocator_t>;
+        using edge_column_t = detail::value_column_for<EdgeValueT, allocator_t>;
+
+        explicit graph_base(allocator_t const& a = allocator_t())  //顶点,边以及邻接集合的内存均从a(的rebind)中分配
+            : vertex_repository(a), edge_repository(a), vertex_values_(a), edge_values_(a)
+        {}
+
+        allocator_t get_allocator() const
+        {
+            return allocator_t(vertex_repository.get_allocator());
+        }
 
         bool associated(vertex_id v, edge_id e)
         {
@@ -39,7 +107,7 @@ namespace lzhlib
         template<class ...Args>
         vertex_id add_vertex(Args&& ...args)
         {
-            return vertex_repository.add_stock(std::forward<Args>(args)...);
+            return add_vertex_stock(typename vertex_layout_t::is_columnar{}, std::forward<Args>(args)...);
         }
 
         pair_t associated_vertices(edge_id e) const
@@ -49,19 +117,57 @@ namespace lzhlib
 
         vertex_value_t& value(vertex_id v)
         {
-            return get_vertex(v).vertex_value();
+            return vertex_value(v, typename vertex_layout_t::is_columnar{});
         }
         vertex_value_t const& value(vertex_id v) const
         {
-            return get_vertex(v).vertex_value();
+            return vertex_value(v, typename vertex_layout_t::is_columnar{});
         }
         edge_value_t& value(edge_id e)
         {
-            return get_edge(e).edge_value();
+            return edge_value(e, typename edge_layout_t::is_columnar{});
         }
         edge_value_t const& value(edge_id e) const
         {
-            return get_edge(e).edge_value();
+            return edge_value(e, typename edge_layout_t::is_columnar{});
+        }
+
+        column_span<vertex_value_t> vertex_values()        //只在VertexValueT为columnar<T>时可用.下标为index(v),已删除的位置上为T()
+        {
+            static_assert(vertex_layout_t::is_columnar::value, "vertex_values() requires columnar vertex values");
+            return vertex_values_.span();
+        }
+        column_span<vertex_value_t const> vertex_values() const
+        {
+            static_assert(vertex_layout_t::is_columnar::value, "vertex_values() requires columnar vertex values");
+            return vertex_values_.span();
+        }
+        column_span<edge_value_t> edge_values()            //只在EdgeValueT为columnar<T>时可用.下标为index(e),已删除的位置上为T()
+        {
+            static_assert(edge_layout_t::is_columnar::value, "edge_values() requires columnar edge values");
+            return edge_values_.span();
+        }
+        column_span<edge_value_t const> edge_values() const
+        {
+            static_assert(edge_layout_t::is_columnar::value, "edge_values() requires columnar edge values");
+            return edge_values_.span();
+        }
+
+        std::size_t index(vertex_id v) const noexcept    //v在按id排列的数组(如vertex_values())中的下标
+        {
+            return v.id().id();
+        }
+        std::size_t index(edge_id e) const noexcept
+        {
+            return e.id().id();
+        }
+        std::size_t vertex_index_bound() const noexcept  //所有有效顶点的index都小于此值
+        {
+            return vertex_repository.slot_count();
+        }
+        std::size_t edge_index_bound() const noexcept
+        {
+            return edge_repository.slot_count();
         }
 
         vertex_id first_vertex() const
@@ -79,6 +185,61 @@ namespace lzhlib
             return vertex_repository.next_stock(id.id());
         }
 
+        void reserve(std::size_t vertices, std::size_t edges)
+        {
+            vertex_repository.reserve(vertices);
+            edge_repository.reserve(edges);
+        }
+
+        id_remap compact()   //把所有顶点与边依原有顺序重新编号为[0,vertex_count())与[0,edge_count()),并释放空余的slot.O(V+E)
+        {
+            std::size_t const npos = id_remap::npos;
+            std::vector<std::size_t> vertex_map(vertex_index_bound(), npos);
+            std::vector<std::size_t> edge_map(edge_index_bound(), npos);
+            std::size_t n = 0;
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+                vertex_map[index(v)] = n++;
+            std::size_t m = 0;
+            for (auto e = edge_repository.first_stock(); !edge_repository.stock_end(e); e = edge_repository.next_stock(e))
+                edge_map[e.id()] = m++;
+            renumber(vertex_map, n, edge_map, m);
+            return id_remap(std::move(vertex_map), std::move(edge_map));
+        }
+        /*
+         * 按vertex_map(旧index -> 新index)重新排列顶点,vertex_map须把所有存在的顶点一一映射到[0,vertex_count()).
+         * 边按新顶点顺序依次编号(每个顶点的关联边排在一起),同时完成compact.O(V+E)
+         */
+        id_remap reorder(std::vector<std::size_t> vertex_map)
+        {
+            return reorder_vertices(std::move(vertex_map), [this](vertex_id v) -> auto const&
+            {
+                return associated_edges(v);
+            });
+        }
+
+        std::size_t vertex_count() const noexcept
+        {
+            return vertex_repository.size();
+        }
+        std::size_t edge_count() const noexcept
+        {
+            return edge_repository.size();
+        }
+
+        graph_memory_usage memory_usage() const  //O(V)
+        {
+            using vertex_value_size = detail::value_footprint<typename vertex_layout_t::stored_t>;
+            using edge_value_size = detail::value_footprint<typename edge_layout_t::stored_t>;
+            graph_memory_usage ret;
+            ret.vertex_store = vertex_repository.memory_usage() - vertex_count() * vertex_value_size::value;
+            ret.edge_store = edge_repository.memory_usage() - edge_count() * edge_value_size::value;
+            ret.values = vertex_count() * vertex_value_size::value + edge_count() * edge_value_size::value +
+                         vertex_values_.memory_usage() + edge_values_.memory_usage();
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+                ret.adjacency += associated_edges(v).size() * (detail::set_node_overhead + sizeof(edge_ref_t));
+            return ret;
+        }
+
     protected:
 
         vertex_t& get_vertex(vertex_id v)
@@ -98,6 +259,209 @@ namespace lzhlib
             return edge_repository.get_stock(e.id());
         }
 
+        template<class ...Args>
+        edge_id emplace_edge(Args&& ...args)    //分配一条尚未连接的边;端点由派生类设置
+        {
+            return emplace_edge_stock(typename edge_layout_t::is_columnar{}, std::forward<Args>(args)...);
+        }
+        edge_id emplace_edge(detail::empty_value&&)     //for values coming from storable_value<null_value_tag>
+        {
+            return emplace_edge();
+        }
+        void release_vertex(vertex_id v)        //只释放v本身,与v关联的边由派生类先行处理
+        {
+            vertex_repository.remove_stock(v.id());
+            vertex_values_.reset(v.id());
+        }
+        void release_edge(edge_id e)
+        {
+            edge_repository.remove_stock(e.id());
+            edge_values_.reset(e.id());
+        }
+
+        //按vertex_map/edge_map(旧index -> 新index,已删除的为id_remap::npos)移动所有顶点,边和值,并改写其中保存的id
+        void renumber(std::vector<std::size_t> const& vertex_map, std::size_t vertex_slots,
+                      std::vector<std::size_t> const& edge_map, std::size_t edge_slots)
+        {
+            vertex_repository.renumber(vertex_map, vertex_slots);
+            edge_repository.renumber(edge_map, edge_slots);
+            vertex_values_.renumber(vertex_map, vertex_slots);
+            edge_values_.renumber(edge_map, edge_slots);
+            auto new_vertex = [&vertex_map](vertex_id old)
+            {
+                return vertex_id{vertex_map[old.id().id()]};
+            };
+            for (auto e = edge_repository.first_stock(); !edge_repository.stock_end(e); e = edge_repository.next_stock(e))
+            {
+                edge_t& edge = edge_repository.get_stock(e);
+                pair_t ends = edge.associated_vertices();
+                edge.set_associated_vertices(new_vertex(ends.first), new_vertex(ends.second));
+            }
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+            {
+                get_vertex(v).rewrite_associated_edges([&](edge_ref_t r)
+                                                       {
+                                                           return edge_ref_t{edge_id{edge_map[r.edge().id().id()]},
+                                                                             new_vertex(r.opposite_vertex())};
+                                                       });
+            }
+        }
+
+        template<class EdgesOfF>
+        id_remap reorder_vertices(std::vector<std::size_t> vertex_map, EdgesOfF edges_of)  //见reorder.edges_of(v)给出v的关联边,决定边的新编号
+        {
+            std::size_t const npos = id_remap::npos;
+            std::size_t const n = vertex_count();
+            vertex_map.resize(vertex_index_bound(), npos);
+            std::vector<vertex_id> order(n);              //新index -> 顶点
+            std::vector<bool> placed(n, false);
+            std::vector<std::size_t> live_map(vertex_index_bound(), npos);    //只保留存在的顶点,其余slot上的值被忽略
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+            {
+                std::size_t const k = vertex_map[index(v)];
+                assert(k < n && !placed[k]);            //存在的顶点须一一映射到[0,n)
+                placed[k] = true;
+                order[k] = v;
+                live_map[index(v)] = k;
+            }
+            vertex_map.swap(live_map);
+            std::vector<std::size_t> edge_map(edge_index_bound(), npos);
+            std::size_t m = 0;
+            for (vertex_id v : order)
+                for (auto const& r : edges_of(v))
+                    if (edge_map[index(r.edge())] == npos)
+                        edge_map[index(r.edge())] = m++;
+            renumber(vertex_map, n, edge_map, m);
+            return id_remap(std::move(vertex_map), std::move(edge_map));
+        }
+
+        //见mutation_batch.h.返回新边的id,顺序与batch中的add_edge相同.adjacency为派生类的邻接存储策略,indexed时不维护顶点的边集合
+        template<class BatchT, class AdjacencyT>
+        std::vector<edge_id> apply_batch(BatchT& batch, bool directed, AdjacencyT& adjacency)
+        {
+            using indexed = std::integral_constant<bool, AdjacencyT::indexed>;
+            std::vector<vertex_id> dead_vertices = batch.removed_vertices();
+            std::sort(dead_vertices.begin(), dead_vertices.end());
+            dead_vertices.erase(std::unique(dead_vertices.begin(), dead_vertices.end()), dead_vertices.end());
+            std::vector<edge_id> dead_edges = batch.removed_edges();
+            for (vertex_id v : dead_vertices)
+                collect_incident_edges(v, directed, adjacency, dead_edges, indexed{});
+            std::sort(dead_edges.begin(), dead_edges.end());
+            dead_edges.erase(std::unique(dead_edges.begin(), dead_edges.end()), dead_edges.end());
+
+            auto is_dead = [&dead_vertices](vertex_id v)
+            {
+                return std::binary_search(dead_vertices.begin(), dead_vertices.end(), v);
+            };
+            unlink_edges(dead_edges, is_dead, directed, adjacency, indexed{});
+            for (edge_id e : dead_edges)
+                release_edge(e);
+            for (vertex_id v : dead_vertices)
+            {
+                adjacency.remove_vertex(index(v));
+                release_vertex(v);
+            }
+
+            auto& additions = batch.additions();
+            std::vector<edge_id> added;
+            added.reserve(additions.size());
+            for (auto& a : additions)
+            {
+                assert(!is_dead(a.x) && !is_dead(a.y));
+                edge_id e = emplace_edge(std::move(a.value));
+                get_edge(e).set_associated_vertices(a.x, a.y);
+                added.push_back(e);
+            }
+            link_edges(added, directed, adjacency, indexed{});
+            batch.clear();
+            return added;
+        }
+
+    private:
+        template<class AdjacencyT>
+        void collect_incident_edges(vertex_id v, bool, AdjacencyT const&, std::vector<edge_id>& out, std::false_type) const
+        {
+            for (edge_ref_t e : get_vertex(v).associated_edges())
+                out.push_back(e.edge());
+        }
+        template<class AdjacencyT>
+        void collect_incident_edges(vertex_id v, bool directed, AdjacencyT const& adjacency, std::vector<edge_id>& out,
+                                    std::true_type) const
+        {
+            adjacency.for_each_incident_edge(index(v), directed, [&out](edge_id e)
+            {
+                out.push_back(e);
+            });
+        }
+        template<class IsDeadF, class AdjacencyT>
+        void unlink_edges(std::vector<edge_id> const& dead_edges, IsDeadF is_dead, bool directed, AdjacencyT&, std::false_type)
+        {
+            std::vector<std::pair<vertex_id, edge_id>> erasures;     //(endpoint, edge), grouped per endpoint below
+            erasures.reserve(dead_edges.size() * 2);
+            for (edge_id e : dead_edges)
+            {
+                pair_t ends = get_edge(e).associated_vertices();
+                if (!is_dead(ends.first))
+                    erasures.emplace_back(ends.first, e);
+                if (!directed && !(ends.first == ends.second) && !is_dead(ends.second))
+                    erasures.emplace_back(ends.second, e);
+            }
+            std::sort(erasures.begin(), erasures.end());
+            std::vector<edge_id> run;
+            for (auto i = erasures.begin(); i != erasures.end();)
+            {
+                auto j = i;
+                run.clear();
+                for (; j != erasures.end() && j->first == i->first; ++j)
+                    run.push_back(j->second);
+                get_vertex(i->first).remove_associated_edges_sorted(run.begin(), run.end());
+                i = j;
+            }
+        }
+        template<class IsDeadF, class AdjacencyT>
+        void unlink_edges(std::vector<edge_id> const& dead_edges, IsDeadF, bool directed, AdjacencyT& adjacency, std::true_type)
+        {
+            for (edge_id e : dead_edges)
+            {
+                pair_t ends = get_edge(e).associated_vertices();
+                adjacency.remove_edge(index(ends.first), index(ends.second), directed);
+            }
+        }
+        template<class AdjacencyT>
+        void link_edges(std::vector<edge_id> const& added, bool directed, AdjacencyT&, std::false_type)
+        {
+            std::vector<std::pair<vertex_id, edge_ref_t>> insertions;
+            insertions.reserve(added.size() * 2);
+            for (edge_id e : added)
+            {
+                pair_t ends = get_edge(e).associated_vertices();
+                insertions.emplace_back(ends.first, edge_ref_t{e, ends.second});
+                if (!directed && !(ends.first == ends.second))
+                    insertions.emplace_back(ends.second, edge_ref_t{e, ends.first});
+            }
+            std::sort(insertions.begin(), insertions.end());
+            std::vector<edge_ref_t> refs;
+            for (auto i = insertions.begin(); i != insertions.end();)
+            {
+                auto j = i;
+                refs.clear();
+                for (; j != insertions.end() && j->first == i->first; ++j)
+                    refs.push_back(j->second);
+                get_vertex(i->first).add_associated_edges_sorted(refs.begin(), refs.end());
+                i = j;
+            }
+        }
+        template<class AdjacencyT>
+        void link_edges(std::vector<edge_id> const& added, bool directed, AdjacencyT& adjacency, std::true_type)
+        {
+            for (edge_id e : added)
+            {
+                pair_t ends = get_edge(e).associated_vertices();
+                adjacency.add_edge(index(ends.first), index(ends.second), e, directed);
+            }
+        }
+
+    protected:
         vertex_id to_vertex_id(stock_id i)    //preserved.Direved class don't need this just for now.
         {
             return i;
@@ -114,8 +478,111 @@ namespace lzhlib
         {
             return e.id();
         }
-        repository<vertex_t> vertex_repository;
-        repository<edge_t> edge_repository;
+        vertex_repository_t vertex_repository;
+        edge_repository_t edge_repository;
+        vertex_column_t vertex_values_;
+        edge_column_t edge_values_;
+
+    private:
+        typename vertex_t::allocator_t adjacency_allocator() const
+        {
+            return typename vertex_t::allocator_t(vertex_repository.get_allocator());
+        }
+
+        template<class ...Args>
+        vertex_id add_vertex_stock(std::false_type, Args&& ...args)
+        {
+            return vertex_repository.add_stock(std::allocator_arg, adjacency_allocator(), std::forward<Args>(args)...);
+        }
+        template<class ...Args>
+        vertex_id add_vertex_stock(std::true_type, Args&& ...args)
+        {
+            stock_id id = vertex_repository.add_stock(std::allocator_arg, adjacency_allocator());
+            try
+            {
+                vertex_values_.emplace(id, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                vertex_repository.remove_stock(id);
+                throw;
+            }
+            return id;
+        }
+        template<class ...Args>
+        edge_id emplace_edge_stock(std::false_type, Args&& ...args)
+        {
+            return edge_repository.add_stock(std::forward<Args>(args)...);
+        }
+        template<class ...Args>
+        edge_id emplace_edge_stock(std::true_type, Args&& ...args)
+        {
+            stock_id id = edge_repository.add_stock();
+            try
+            {
+                edge_values_.emplace(id, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                edge_repository.remove_stock(id);
+                throw;
+            }
+            return id;
+        }
+
+        //列中的值不经过repository,debug下仍做与get_vertex/get_edge相同的有效性检查
+        void check_vertex(vertex_id v) const
+        {
+#ifndef NDEBUG
+            get_vertex(v);
+#else
+            (void)v;
+#endif // NDEBUG
+        }
+        void check_edge(edge_id e) const
+        {
+#ifndef NDEBUG
+            get_edge(e);
+#else
+            (void)e;
+#endif // NDEBUG
+        }
+        vertex_value_t& vertex_value(vertex_id v, std::false_type)
+        {
+            return get_vertex(v).vertex_value();
+        }
+        vertex_value_t const& vertex_value(vertex_id v, std::false_type) const
+        {
+            return get_vertex(v).vertex_value();
+        }
+        vertex_value_t& vertex_value(vertex_id v, std::true_type)
+        {
+            check_vertex(v);
+            return vertex_values_[v.id()];
+        }
+        vertex_value_t const& vertex_value(vertex_id v, std::true_type) const
+        {
+            check_vertex(v);
+            return vertex_values_[v.id()];
+        }
+        edge_value_t& edge_value(edge_id e, std::false_type)
+        {
+            return get_edge(e).edge_value();
+        }
+        edge_value_t const& edge_value(edge_id e, std::false_type) const
+        {
+            return get_edge(e).edge_value();
+        }
+        edge_value_t& edge_value(edge_id e, std::true_type)
+        {
+            check_edge(e);
+            return edge_values_[e.id()];
+        }
+        edge_value_t const& edge_value(edge_id e, std::true_type) const
+        {
+            check_edge(e);
+            return edge_values_[e.id()];
+        }
     };
 }
 #endif //GRAPH_GRAPH_BASE_H
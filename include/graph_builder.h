@@ -0,0 +1,247 @@
+#ifndef GRAPH_GRAPH_BUILDER_H
+#define GRAPH_GRAPH_BUILDER_H
+
+#include <algorithm>  //for std::sort
+#include <array>      //for std::array
+#include <atomic>     //for std::atomic
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t
+#include <mutex>      //for std::mutex, std::lock_guard
+#include <new>        //for placement new
+#include <type_traits>    //for std::aligned_storage
+#include <utility>    //for std::forward, std::move
+#include <vector>     //for std::vector
+#include "Graph/include/id_access.h"
+#include "Graph/include/value_column.h"
+#include "Graph/include/vertex.h"
+
+/** \file
+ *  \brief 多线程并行地构造undirected_graph/directed_graph.
+ *
+ * 多个线程可同时调用concurrent_graph_builder的add_vertex/add_edge:
+ * 顶点与边的id由原子计数器预留,存储位于只增不减的分段数组中,
+ * 每个顶点的邻接表在分段锁(按顶点下标取模)的保护下追加.
+ * 所有线程结束后,由一个线程调用finalize()得到普通的图,其中顶点与边的id与构造时返回的相同.
+ */
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        template<class T>
+        class manual_slot          //storage whose lifetime is managed by the owner
+        {
+        public:
+            manual_slot() = default;
+            manual_slot(manual_slot const&) = delete;
+            manual_slot& operator=(manual_slot const&) = delete;
+            ~manual_slot()
+            {
+                if (constructed)
+                    get().~T();
+            }
+
+            template<class ...Args>
+            void construct(Args&& ...args)
+            {
+                ::new(static_cast<void*>(&storage)) T(std::forward<Args>(args)...);
+                constructed = true;
+            }
+            T& get() noexcept
+            {
+                return *reinterpret_cast<T*>(&storage);
+            }
+            bool has_value() const noexcept
+            {
+                return constructed;
+            }
+
+        private:
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+            bool constructed = false;
+        };
+
+        /*
+         * 只增不减的分段数组.第s段有(first_segment_size << s)个元素,已分配的段永不移动,
+         * 因此at(i)返回的引用一直有效;不同线程可同时访问不同(或相同)下标,段的分配通过CAS完成.
+         */
+        template<class T>
+        class segmented_array
+        {
+        public:
+            static constexpr std::size_t first_segment_size = 1024;
+            static constexpr std::size_t max_segments = 40;
+
+            segmented_array()
+            {
+                for (auto& s : segments)
+                    s.store(nullptr, std::memory_order_relaxed);
+            }
+            segmented_array(segmented_array const&) = delete;
+            segmented_array& operator=(segmented_array const&) = delete;
+            ~segmented_array()
+            {
+                for (auto& s : segments)
+                    delete[] s.load(std::memory_order_relaxed);
+            }
+
+            T& at(std::size_t i)
+            {
+                std::size_t segment = 0;
+                std::size_t size = first_segment_size;
+                while (i >= size)
+                {
+                    i -= size;
+                    size <<= 1;
+                    ++segment;
+                }
+                T* p = segments[segment].load(std::memory_order_acquire);
+                if (p == nullptr)
+                {
+                    T* fresh = new T[size];
+                    if (segments[segment].compare_exchange_strong(p, fresh, std::memory_order_acq_rel))
+                        p = fresh;
+                    else
+                        delete[] fresh;      //another thread won; p now holds its segment
+                }
+                return p[i];
+            }
+
+        private:
+            std::array<std::atomic<T*>, max_segments> segments;
+        };
+    }
+
+    template<class GraphT>
+    class concurrent_graph_builder
+    {
+    public:
+        using graph_t = GraphT;
+        using vertex_value_t = typename detail::storable_value<typename graph_t::vertex_value_t>::type;
+        using edge_value_t = typename detail::storable_value<typename graph_t::edge_value_t>::type;
+        using allocator_t = typename graph_t::allocator_t;
+        static constexpr std::size_t lock_stripes = 256;
+
+        concurrent_graph_builder() = default;
+        concurrent_graph_builder(concurrent_graph_builder const&) = delete;
+        concurrent_graph_builder& operator=(concurrent_graph_builder const&) = delete;
+
+        //thread-safe.值先在预留id之前构造,构造抛出异常时不会留下没有值的id;值的移动构造不应抛出异常
+        template<class ...Args>
+        vertex_id add_vertex(Args&& ...args)
+        {
+            detail::manual_slot<vertex_value_t> value;
+            value.construct(std::forward<Args>(args)...);
+            std::size_t i = vertex_counter.fetch_add(1, std::memory_order_relaxed);
+            vertices.at(i).value.construct(std::move(value.get()));
+            return detail::id_access::make_vertex_id(i);
+        }
+        template<class ...Args>
+        edge_id add_edge(vertex_id x, vertex_id y, Args&& ...args)   //precondition: x与y已由add_vertex返回
+        {
+            detail::manual_slot<edge_value_t> value;
+            value.construct(std::forward<Args>(args)...);
+            std::size_t i = edge_counter.fetch_add(1, std::memory_order_relaxed);
+            edge_id e = detail::id_access::make_edge_id(i);
+            edge_slot& slot = edges.at(i);
+            slot.x = x;
+            slot.y = y;
+            slot.value.construct(std::move(value.get()));
+            append(x, {e, y});
+            if (!graph_t::is_directed && !(x == y))
+                append(y, {e, x});
+            return e;
+        }
+
+        std::size_t vertex_count() const noexcept
+        {
+            return vertex_counter.load(std::memory_order_relaxed);
+        }
+        std::size_t edge_count() const noexcept
+        {
+            return edge_counter.load(std::memory_order_relaxed);
+        }
+
+        //单线程调用,且须在所有add_vertex/add_edge返回之后.builder中的值被移入返回的图中,之后builder不应再被使用
+        graph_t finalize(allocator_t const& a = allocator_t())
+        {
+            std::size_t const n = vertex_count();
+            std::size_t const m = edge_count();
+            graph_t g(a);
+            typename graph_t::base& topology = g;      //derived graphs hide graph_base::get_edge(edge_id)
+            g.reserve(n, m);
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                assert(vertices.at(i).value.has_value());
+                emplace_vertex(g, std::move(vertices.at(i).value.get()));
+            }
+            for (std::size_t i = 0; i != m; ++i)
+            {
+                edge_slot& slot = edges.at(i);
+                assert(slot.value.has_value());
+                edge_id e = emplace_edge(g, std::move(slot.value.get()));
+                topology.get_edge(e).set_associated_vertices(slot.x, slot.y);
+            }
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                auto& adjacency = vertices.at(i).adjacency;
+                if (!graph_t::adjacency_t::indexed)     //matrix_adjacency不使用顶点的边集合,由rebuild_adjacency按边建立矩阵
+                {
+                    std::sort(adjacency.begin(), adjacency.end());
+                    topology.get_vertex(detail::id_access::make_vertex_id(i))
+                        .add_associated_edges_sorted(adjacency.begin(), adjacency.end());
+                }
+                std::vector<detail::edge_ref>().swap(adjacency);
+            }
+            g.rebuild_adjacency();
+            return g;
+        }
+
+    private:
+        struct vertex_slot
+        {
+            detail::manual_slot<vertex_value_t> value;
+            std::vector<detail::edge_ref> adjacency;    //unsorted until finalize
+        };
+        struct edge_slot
+        {
+            vertex_id x;
+            vertex_id y;
+            detail::manual_slot<edge_value_t> value;
+        };
+
+        void append(vertex_id v, detail::edge_ref r)
+        {
+            std::size_t i = detail::id_access::to_stock_id(v).id();
+            std::lock_guard<std::mutex> lock(stripes[i % lock_stripes]);
+            vertices.at(i).adjacency.push_back(r);
+        }
+
+        static vertex_id emplace_vertex(graph_t& g, detail::empty_value&&)
+        {
+            return g.add_vertex();
+        }
+        template<class ValueT>
+        static vertex_id emplace_vertex(graph_t& g, ValueT&& value)
+        {
+            return g.add_vertex(std::forward<ValueT>(value));
+        }
+        static edge_id emplace_edge(graph_t& g, detail::empty_value&&)
+        {
+            return g.emplace_edge();
+        }
+        template<class ValueT>
+        static edge_id emplace_edge(graph_t& g, ValueT&& value)
+        {
+            return g.emplace_edge(std::forward<ValueT>(value));
+        }
+
+        std::atomic<std::size_t> vertex_counter{0};
+        std::atomic<std::size_t> edge_counter{0};
+        detail::segmented_array<vertex_slot> vertices;
+        detail::segmented_array<edge_slot> edges;
+        std::array<std::mutex, lock_stripes> stripes;
+    };
+}
+
+#endif //GRAPH_GRAPH_BUILDER_H
@@ -0,0 +1,34 @@
+#ifndef GRAPH_ID_ACCESS_H
+#define GRAPH_ID_ACCESS_H
+
+#include "Graph/include/stock_id.h"
+#include "Graph/include/vertex_id.h"
+#include "Graph/include/edge_id.h"
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        struct id_access        //库内部不经过graph_base而需要构造/拆开vertex_id与edge_id的组件通过这里进行
+        {
+            static vertex_id make_vertex_id(stock_id i)
+            {
+                return vertex_id{i};
+            }
+            static edge_id make_edge_id(stock_id i)
+            {
+                return edge_id{i};
+            }
+            static stock_id to_stock_id(vertex_id v)
+            {
+                return v.id();
+            }
+            static stock_id to_stock_id(edge_id e)
+            {
+                return e.id();
+            }
+        };
+    }
+}
+
+#endif //GRAPH_ID_ACCESS_H
@@ -0,0 +1,60 @@
+#ifndef GRAPH_ID_REMAP_H
+#define GRAPH_ID_REMAP_H
+
+#include <cstddef>    //for std::size_t
+#include <utility>    //for std::move
+#include <vector>     //for std::vector
+#include "Graph/include/id_access.h"
+
+namespace lzhlib
+{
+    /*
+     * 重新编号(compact,reorder等)之后,旧id到新id的对应关系.
+     * 调用者用它把自己保存的vertex_id/edge_id以及按index排列的数组转换到新的编号.
+     */
+    class id_remap
+    {
+    public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        id_remap(std::vector<std::size_t> vertex_map, std::vector<std::size_t> edge_map)
+            : vertices(std::move(vertex_map)), edges(std::move(edge_map))
+        {}
+
+        bool contains(vertex_id old) const   //old在重新编号时是否仍然存在
+        {
+            std::size_t i = detail::id_access::to_stock_id(old).id();
+            return i < vertices.size() && vertices[i] != npos;
+        }
+        bool contains(edge_id old) const
+        {
+            std::size_t i = detail::id_access::to_stock_id(old).id();
+            return i < edges.size() && edges[i] != npos;
+        }
+        vertex_id operator()(vertex_id old) const   //已不存在的顶点映射为invalid_vertex_id
+        {
+            if (!contains(old))
+                return invalid_vertex_id;
+            return detail::id_access::make_vertex_id(vertices[detail::id_access::to_stock_id(old).id()]);
+        }
+        edge_id operator()(edge_id old) const       //precondition: contains(old)
+        {
+            return detail::id_access::make_edge_id(edges[detail::id_access::to_stock_id(old).id()]);
+        }
+
+        std::vector<std::size_t> const& vertex_map() const noexcept  //旧index -> 新index,已删除的为npos
+        {
+            return vertices;
+        }
+        std::vector<std::size_t> const& edge_map() const noexcept
+        {
+            return edges;
+        }
+
+    private:
+        std::vector<std::size_t> vertices;
+        std::vector<std::size_t> edges;
+    };
+}
+
+#endif //GRAPH_ID_REMAP_H
@@ -0,0 +1,184 @@
+#ifndef GRAPH_INLINE_REPOSITORY_H
+#define GRAPH_INLINE_REPOSITORY_H
+
+#include <climits>    //for CHAR_BIT
+#include <memory>     //for std::allocator, std::allocator_traits
+#include <vector>     //for std::vector
+#include "Graph/include/repository.h"
+
+namespace lzhlib
+{
+    /*
+     * 与repository接口相同,但stock直接存放在连续的数组中,而不是逐个分配.
+     * 每个slot只需sizeof(StockT)再加1 bit的有效标记,适合体积小且可移动的stock,例如只保存端点的edge<null_value_tag>.
+     * 空出的slot与repository一样按从低到高的顺序复用,因此两者分配的id相同.
+     * 注意:add_stock可能使之前由get_stock得到的引用失效.
+     */
+    template<class StockT, class AllocatorT = std::allocator<StockT>>
+    class inline_repository
+    {
+    public:
+        using stock_t = StockT;
+        using id_t = stock_id;
+        using allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<stock_t>;
+
+        using attempt_to_use_unassigned_stock = typename repository<StockT, AllocatorT>::attempt_to_use_unassigned_stock;
+        using attempt_to_remove_nonexistent_stock = typename repository<StockT, AllocatorT>::attempt_to_remove_nonexistent_stock;
+
+        explicit inline_repository(allocator_t const& a = allocator_t())
+            : stocks(a), valid(bool_allocator_t(a))
+        {}
+
+        allocator_t get_allocator() const
+        {
+            return stocks.get_allocator();
+        }
+
+        stock_t& get_stock(id_t id)
+        {
+            LZHLIB_GRAPH_COUNT(stock_lookups, 1);
+#ifndef NDEBUG
+            if (is_not_valid(id))
+            {
+                throw attempt_to_use_unassigned_stock(id);
+            }
+#endif // NDEBUG
+            return stocks[id.id()];
+        }
+        stock_t const& get_stock(id_t id) const
+        {
+            LZHLIB_GRAPH_COUNT(stock_lookups, 1);
+#ifndef NDEBUG
+            if (is_not_valid(id))
+            {
+                throw attempt_to_use_unassigned_stock(id);
+            }
+#endif // NDEBUG
+            return stocks[id.id()];
+        }
+        template<class ...Args>
+        id_t add_stock(Args&& ... args)
+        {
+            id_t ret = reusable_stock();
+            if (ret == stocks.size())  //no reusable stock
+            {
+                LZHLIB_GRAPH_TIME(stock_allocation);
+                LZHLIB_GRAPH_COUNT(stock_allocations, 1);
+                stocks.emplace_back(std::forward<Args>(args)...);
+                valid.push_back(true);
+            }
+            else
+            {
+                LZHLIB_GRAPH_TIME(stock_reuse);
+                LZHLIB_GRAPH_COUNT(stock_reuses, 1);
+                stocks[ret.id()] = stock_t(std::forward<Args>(args)...);
+                valid[ret.id()] = true;
+            }
+            ++live;
+            first_free = ret;
+            ++first_free;
+            return ret;
+        }
+        void remove_stock(id_t id)
+        {
+#ifndef NDEBUG
+            if (is_not_valid(id))
+                throw attempt_to_remove_nonexistent_stock(id);
+#endif // NDEBUG
+            LZHLIB_GRAPH_COUNT(stock_removals, 1);
+            stocks[id.id()] = stock_t();
+            valid[id.id()] = false;
+            --live;
+            if (id < first_free)
+                first_free = id;
+        }
+        id_t first_stock() const
+        {
+            return stock_at_or_after(id_t{0});
+        }
+        bool stock_end(id_t current) const
+        {
+            return current.id() == stocks.size();
+        }
+        id_t next_stock(id_t current) const        //precondition: current.id() < stocks.size()
+        {
+            return stock_at_or_after(++current);
+        }
+
+        std::size_t size() const noexcept
+        {
+            return live;
+        }
+        std::size_t slot_count() const noexcept
+        {
+            return stocks.size();
+        }
+        std::size_t slot_capacity() const noexcept
+        {
+            return stocks.capacity();
+        }
+        void reserve(std::size_t slots)
+        {
+            stocks.reserve(slots);
+            valid.reserve(slots);
+        }
+        //见repository::renumber
+        void renumber(std::vector<std::size_t> const& new_index, std::size_t new_size)
+        {
+            std::vector<stock_t, allocator_t> renumbered(stocks.get_allocator());
+            renumbered.resize(new_size);
+            std::vector<bool, bool_allocator_t> renumbered_valid(new_size, false, valid.get_allocator());
+            for (std::size_t i = 0; i != stocks.size(); ++i)
+            {
+                if (valid[i])
+                {
+                    renumbered[new_index[i]] = std::move(stocks[i]);
+                    renumbered_valid[new_index[i]] = true;
+                }
+            }
+            stocks.swap(renumbered);
+            valid.swap(renumbered_valid);
+            first_free = id_t{0};
+        }
+        std::size_t memory_usage() const noexcept   //bytes held by the slots and the validity bits
+        {
+            return stocks.capacity() * sizeof(stock_t) + valid.capacity() / CHAR_BIT;
+        }
+
+    private:
+        using bool_allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<bool>;
+
+#ifndef NDEBUG
+        bool is_not_valid(id_t id) const
+        {
+            return id.id() >= stocks.size() || !valid[id.id()];
+        }
+#endif // NDEBUG
+        id_t reusable_stock() const               //见repository::reusable_stock
+        {
+            LZHLIB_GRAPH_TIME(reuse_probe);
+            id_t current = first_free;
+            while (current.id() != stocks.size() && valid[current.id()])
+                ++current;
+            LZHLIB_GRAPH_COUNT(reuse_probe_length, current.id() - first_free.id());
+            return current;
+        }
+        id_t stock_at_or_after(id_t current) const //precondition: current.id() <= stocks.size()
+        {
+#ifdef LZHLIB_GRAPH_INSTRUMENTATION
+            id_t const start = current;
+#endif // LZHLIB_GRAPH_INSTRUMENTATION
+            while (current.id() != stocks.size() && !valid[current.id()])
+                ++current;
+            LZHLIB_GRAPH_COUNT(iteration_skips, current.id() - start.id());
+            return current;
+        }
+
+        std::vector<stock_t, allocator_t> stocks;
+        std::vector<bool, bool_allocator_t> valid;
+        std::size_t live = 0;
+        id_t first_free{0};        //lowest slot that may be reusable; every slot before it holds a stock
+    };
+}
+
+#endif //GRAPH_INLINE_REPOSITORY_H
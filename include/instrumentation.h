@@ -0,0 +1,182 @@
+#ifndef GRAPH_INSTRUMENTATION_H
+#define GRAPH_INSTRUMENTATION_H
+
+#include <array>      //for std::array
+#include <atomic>     //for std::atomic
+#include <chrono>     //for std::chrono::steady_clock
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+
+/** \file
+ *  \brief 热路径计数与计时.
+ *
+ * 定义宏 LZHLIB_GRAPH_INSTRUMENTATION 后, repository 与 vertex 中的
+ * LZHLIB_GRAPH_COUNT / LZHLIB_GRAPH_TIME 才会展开为真正的计数与计时代码;
+ * 未定义时它们展开为空,热路径上不留下任何指令.
+ * instrumentation::snapshot() 与 instrumentation::reset() 在两种情况下都可调用,
+ * 未启用时 snapshot() 恒返回全零,这样导出指标的代码不必写 #ifdef.
+ */
+
+namespace lzhlib
+{
+    namespace instrumentation
+    {
+#ifdef LZHLIB_GRAPH_INSTRUMENTATION
+        constexpr bool enabled = true;
+#else
+        constexpr bool enabled = false;
+#endif // LZHLIB_GRAPH_INSTRUMENTATION
+
+        enum class counter : std::size_t
+        {
+            stock_allocations,      //repository::allocate_stock
+            stock_reuses,           //repository::reuse_stock
+            stock_removals,         //repository::remove_stock
+            stock_lookups,          //repository::get_stock (the path that carries the debug check)
+            reuse_probe_length,     //slots visited by repository::reusable_stock
+            iteration_skips,        //empty slots skipped by repository::stock_at_or_after
+            adjacency_inserts,      //vertex::add_associated_edge
+            adjacency_erases,       //vertex::remove_associated_edge
+            adjacency_lookups,      //vertex::adjacent / vertex::associated
+            adjacency_scan_length,  //edge_refs visited by vertex::associated_edge
+            count_
+        };
+
+        enum class timer : std::size_t
+        {
+            stock_allocation,
+            stock_reuse,
+            reuse_probe,
+            adjacency_insert,
+            adjacency_erase,
+            count_
+        };
+
+        constexpr std::size_t counter_count = static_cast<std::size_t>(counter::count_);
+        constexpr std::size_t timer_count = static_cast<std::size_t>(timer::count_);
+
+        inline char const* name(counter c)
+        {
+            static char const* const names[counter_count] = {
+                "stock_allocations", "stock_reuses", "stock_removals", "stock_lookups",
+                "reuse_probe_length", "iteration_skips", "adjacency_inserts",
+                "adjacency_erases", "adjacency_lookups", "adjacency_scan_length"};
+            return names[static_cast<std::size_t>(c)];
+        }
+        inline char const* name(timer t)
+        {
+            static char const* const names[timer_count] = {
+                "stock_allocation", "stock_reuse", "reuse_probe", "adjacency_insert",
+                "adjacency_erase"};
+            return names[static_cast<std::size_t>(t)];
+        }
+
+        struct statistics           //a plain copy of the global counters, suitable for exporting
+        {
+            std::uint64_t value(counter c) const
+            {
+                return counters[static_cast<std::size_t>(c)];
+            }
+            std::uint64_t calls(timer t) const
+            {
+                return timer_calls[static_cast<std::size_t>(t)];
+            }
+            std::uint64_t nanoseconds(timer t) const
+            {
+                return timer_nanoseconds[static_cast<std::size_t>(t)];
+            }
+
+            std::array<std::uint64_t, counter_count> counters{};
+            std::array<std::uint64_t, timer_count> timer_calls{};
+            std::array<std::uint64_t, timer_count> timer_nanoseconds{};
+        };
+
+        namespace detail
+        {
+            struct global_state
+            {
+                std::array<std::atomic<std::uint64_t>, counter_count> counters{};
+                std::array<std::atomic<std::uint64_t>, timer_count> timer_calls{};
+                std::array<std::atomic<std::uint64_t>, timer_count> timer_nanoseconds{};
+            };
+            inline global_state& state()
+            {
+                static global_state s;
+                return s;
+            }
+
+            inline void add(counter c, std::uint64_t n)
+            {
+                state().counters[static_cast<std::size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+            }
+
+            class scoped_timer
+            {
+            public:
+                explicit scoped_timer(timer t)
+                    : t_(t), start_(std::chrono::steady_clock::now())
+                {}
+                scoped_timer(scoped_timer const&) = delete;
+                scoped_timer& operator=(scoped_timer const&) = delete;
+                ~scoped_timer()
+                {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_).count();
+                    auto i = static_cast<std::size_t>(t_);
+                    state().timer_calls[i].fetch_add(1, std::memory_order_relaxed);
+                    state().timer_nanoseconds[i].fetch_add(static_cast<std::uint64_t>(elapsed),
+                                                           std::memory_order_relaxed);
+                }
+
+            private:
+                timer t_;
+                std::chrono::steady_clock::time_point start_;
+            };
+        }
+
+        inline statistics snapshot()
+        {
+            statistics ret;
+            if (!enabled)
+                return ret;
+            auto& s = detail::state();
+            for (std::size_t i = 0; i != counter_count; ++i)
+                ret.counters[i] = s.counters[i].load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i != timer_count; ++i)
+            {
+                ret.timer_calls[i] = s.timer_calls[i].load(std::memory_order_relaxed);
+                ret.timer_nanoseconds[i] = s.timer_nanoseconds[i].load(std::memory_order_relaxed);
+            }
+            return ret;
+        }
+
+        inline void reset()
+        {
+            if (!enabled)
+                return;
+            auto& s = detail::state();
+            for (auto& c : s.counters)
+                c.store(0, std::memory_order_relaxed);
+            for (auto& c : s.timer_calls)
+                c.store(0, std::memory_order_relaxed);
+            for (auto& c : s.timer_nanoseconds)
+                c.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#define LZHLIB_GRAPH_CONCAT_IMPL(a, b) a##b
+#define LZHLIB_GRAPH_CONCAT(a, b) LZHLIB_GRAPH_CONCAT_IMPL(a, b)
+
+#ifdef LZHLIB_GRAPH_INSTRUMENTATION
+#define LZHLIB_GRAPH_COUNT(c, n) \
+    ::lzhlib::instrumentation::detail::add(::lzhlib::instrumentation::counter::c, (n))
+#define LZHLIB_GRAPH_TIME(t) \
+    ::lzhlib::instrumentation::detail::scoped_timer LZHLIB_GRAPH_CONCAT(lzhlib_graph_timer_, __LINE__){ \
+        ::lzhlib::instrumentation::timer::t}
+#else
+#define LZHLIB_GRAPH_COUNT(c, n) ((void)0)
+#define LZHLIB_GRAPH_TIME(t) ((void)0)
+#endif // LZHLIB_GRAPH_INSTRUMENTATION
+
+#endif //GRAPH_INSTRUMENTATION_H
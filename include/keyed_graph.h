@@ -0,0 +1,329 @@
+#ifndef GRAPH_KEYED_GRAPH_H
+#define GRAPH_KEYED_GRAPH_H
+
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <cstring>    //for std::strlen
+#include <functional> //for std::hash
+#include <string>     //for std::string
+#include <type_traits>//for std::decay_t
+#include <utility>    //for std::declval, std::forward, std::pair
+#include <vector>     //for std::vector
+#include "Graph/include/graph_base.h"
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief 带有"键 -> vertex_id"索引的图.
+ *
+ * keyed_graph<GraphT, KeyF>继承GraphT(undirected_graph或directed_graph),键为KeyF作用于顶点的值的结果(默认为值本身).
+ * 索引是一个线性探测的开放寻址表,每个槽只保存键的散列值与顶点的index,键本身仍只存放在顶点的值中,不重复占用内存.
+ * find_vertex与get_or_add_vertex接受任何能与键比较相等,且HashT给出相同散列值的类型(如以std::string为键时的char const*),
+ * 不需要先构造一个键;get_or_add_vertex在未找到时直接把新顶点放入探测时找到的空槽,每次调用只探测一次.
+ *
+ * add_vertex,remove_vertex,apply,compact,reorder会维护索引.顶点的键须互不相同,且在顶点存在期间不被修改;
+ * 若通过value(v)修改了键,或通过其它途径(如concurrent_graph_builder)修改了图,须调用rebuild_key_index().
+ */
+
+namespace lzhlib
+{
+    struct identity_key
+    {
+        template<class T>
+        T const& operator()(T const& x) const noexcept
+        {
+            return x;
+        }
+    };
+
+    //std::string与char const*得到相同的散列值,其它类型使用std::hash
+    struct key_hash
+    {
+        std::size_t operator()(std::string const& s) const noexcept
+        {
+            return bytes(s.data(), s.size());
+        }
+        std::size_t operator()(char const* s) const noexcept
+        {
+            return bytes(s, std::strlen(s));
+        }
+        template<class T>
+        std::size_t operator()(T const& x) const
+        {
+            return std::hash<T>()(x);
+        }
+
+    private:
+        static std::size_t bytes(char const* s, std::size_t n) noexcept    //FNV-1a
+        {
+            std::uint64_t h = 0xcbf29ce484222325ull;
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                h ^= static_cast<unsigned char>(s[i]);
+                h *= 0x100000001b3ull;
+            }
+            return static_cast<std::size_t>(h);
+        }
+    };
+
+    namespace detail
+    {
+        //散列值 -> 顶点index的开放寻址表,不保存键.删除时把后面的槽向前移动,不留墓碑
+        class vertex_key_table
+        {
+        public:
+            static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+            std::size_t size() const noexcept
+            {
+                return size_;
+            }
+
+            /*
+             * 查找散列值为hash且equal(index)为true的槽.
+             * 返回{是否找到, 槽的位置};未找到时位置为可以插入的空槽(表为空时为npos)
+             */
+            template<class EqualF>
+            std::pair<bool, std::size_t> find(std::size_t hash, EqualF equal) const
+            {
+                if (slots.empty())
+                    return {false, std::size_t(npos)};
+                for (std::size_t i = home(hash);; i = (i + 1) & mask())
+                {
+                    slot const& s = slots[i];
+                    if (s.index == npos)
+                        return {false, i};
+                    if (s.hash == hash && equal(s.index))
+                        return {true, i};
+                }
+            }
+            std::size_t index_at(std::size_t position) const noexcept
+            {
+                return slots[position].index;
+            }
+
+            //position为find返回的空槽;需要扩容时返回false,调用者扩容后应重新find
+            bool insert_at(std::size_t position, std::size_t hash, std::size_t index) noexcept
+            {
+                if (position == npos || (size_ + 1) * 4 > slots.size() * 3)
+                    return false;
+                slots[position] = {hash, index};
+                ++size_;
+                return true;
+            }
+            void insert(std::size_t hash, std::size_t index)   //index对应的键不在表中
+            {
+                if ((size_ + 1) * 4 > slots.size() * 3)
+                    grow();
+                std::size_t i = home(hash);
+                while (slots[i].index != npos)
+                    i = (i + 1) & mask();
+                slots[i] = {hash, index};
+                ++size_;
+            }
+            bool erase(std::size_t hash, std::size_t index) noexcept     //index不在表中时返回false
+            {
+                std::pair<bool, std::size_t> r = find(hash, [index](std::size_t i)
+                {
+                    return i == index;
+                });
+                if (!r.first)
+                    return false;
+                std::size_t hole = r.second;
+                for (std::size_t j = (hole + 1) & mask(); slots[j].index != npos; j = (j + 1) & mask())
+                {
+                    std::size_t const h = home(slots[j].hash);
+                    //j的理想位置h不在(hole, j]之间时,j可以前移到hole
+                    bool const stays = hole < j ? (hole < h && h <= j) : (hole < h || h <= j);
+                    if (!stays)
+                    {
+                        slots[hole] = slots[j];
+                        hole = j;
+                    }
+                }
+                slots[hole].index = npos;
+                --size_;
+                return true;
+            }
+            void clear() noexcept
+            {
+                slots.clear();
+                size_ = 0;
+            }
+            void reserve(std::size_t n)
+            {
+                while (n * 4 > slots.size() * 3)
+                    grow();
+            }
+            void grow()
+            {
+                std::vector<slot> old(slots.empty() ? 16 : slots.size() * 2, slot{0, npos});
+                old.swap(slots);
+                shift = 64;
+                for (std::size_t n = slots.size(); n > 1; n /= 2)
+                    --shift;
+                for (slot const& s : old)
+                    if (s.index != npos)
+                    {
+                        std::size_t i = home(s.hash);
+                        while (slots[i].index != npos)
+                            i = (i + 1) & mask();
+                        slots[i] = s;
+                    }
+            }
+
+            std::size_t memory_usage() const noexcept
+            {
+                return slots.capacity() * sizeof(slot);
+            }
+
+        private:
+            struct slot
+            {
+                std::size_t hash;
+                std::size_t index;
+            };
+
+            std::size_t mask() const noexcept
+            {
+                return slots.size() - 1;
+            }
+            std::size_t home(std::size_t hash) const noexcept     //Fibonacci散列,使std::hash<int>这样的恒等散列也能均匀分布
+            {
+                return static_cast<std::size_t>((static_cast<std::uint64_t>(hash) * 0x9e3779b97f4a7c15ull) >> shift);
+            }
+
+            std::vector<slot> slots;        //大小为2的幂
+            std::size_t size_ = 0;
+            unsigned shift = 64;
+        };
+    }
+
+    template<class GraphT, class KeyF = identity_key, class HashT = key_hash>
+    class keyed_graph : public GraphT
+    {
+    public:
+        using graph_t = GraphT;
+        using allocator_t = typename graph_t::allocator_t;
+        using vertex_value_t = typename graph_t::vertex_value_t;
+        using key_t = std::decay_t<decltype(std::declval<KeyF const&>()(std::declval<vertex_value_t const&>()))>;
+        using batch_t = typename graph_t::batch_t;
+
+        explicit keyed_graph(KeyF key_of = KeyF(), HashT hash = HashT())
+            : key_of(key_of), hash(hash)
+        {}
+        explicit keyed_graph(allocator_t const& a, KeyF key_of = KeyF(), HashT hash = HashT())
+            : graph_t(a), key_of(key_of), hash(hash)
+        {}
+
+        template<class ...Args>
+        vertex_id add_vertex(Args&& ...args)        //新顶点的键不能与已有顶点的键相同
+        {
+            vertex_id v = graph_t::add_vertex(std::forward<Args>(args)...);
+            assert(!find_vertex(key(v)).first);
+            table.insert(hash(key(v)), graph_t::index(v));
+            return v;
+        }
+        void remove_vertex(vertex_id v)
+        {
+            table.erase(hash(key(v)), graph_t::index(v));
+            graph_t::remove_vertex(v);
+        }
+        std::vector<edge_id> apply(batch_t& batch)
+        {
+            for (vertex_id v : batch.removed_vertices())
+                table.erase(hash(key(v)), graph_t::index(v));     //重复出现的顶点第二次时不在表中
+            return graph_t::apply(batch);
+        }
+        id_remap compact()
+        {
+            id_remap ret = graph_t::compact();
+            rebuild_key_index();
+            return ret;
+        }
+        id_remap reorder(std::vector<std::size_t> vertex_map)
+        {
+            id_remap ret = graph_t::reorder(std::move(vertex_map));
+            rebuild_key_index();
+            return ret;
+        }
+
+        //返回{是否找到, 顶点}
+        template<class K>
+        std::pair<bool, vertex_id> find_vertex(K const& k) const
+        {
+            std::pair<bool, std::size_t> r = probe(k, hash(k));
+            if (!r.first)
+                return {false, vertex_id()};
+            return {true, detail::id_access::make_vertex_id(table.index_at(r.second))};
+        }
+        //键为k的顶点;不存在时以args(没有args时以k)构造值并添加顶点,新值的键须等于k
+        template<class K, class ...Args>
+        vertex_id get_or_add_vertex(K const& k, Args&& ...args)
+        {
+            std::size_t const h = hash(k);
+            std::pair<bool, std::size_t> r = probe(k, h);
+            if (r.first)
+                return detail::id_access::make_vertex_id(table.index_at(r.second));
+            vertex_id v = make_vertex(k, std::forward<Args>(args)...);
+            assert(key(v) == k);
+            if (!table.insert_at(r.second, h, graph_t::index(v)))
+                table.insert(h, graph_t::index(v));
+            return v;
+        }
+        decltype(auto) key(vertex_id v) const
+        {
+            return key_of(graph_t::value(v));
+        }
+        std::size_t key_count() const noexcept
+        {
+            return table.size();
+        }
+
+        void reserve(std::size_t vertices, std::size_t edges)
+        {
+            graph_t::reserve(vertices, edges);
+            table.reserve(vertices);
+        }
+        void rebuild_key_index()     //O(V)
+        {
+            table.clear();
+            table.reserve(graph_t::vertex_count());
+            for (auto v = graph_t::first_vertex(); !graph_t::vertex_end(v); v = graph_t::next_vertex(v))
+                table.insert(hash(key(v)), graph_t::index(v));
+        }
+
+        graph_memory_usage memory_usage() const  //O(V)
+        {
+            graph_memory_usage ret = graph_t::memory_usage();
+            ret.key_index += table.memory_usage();
+            return ret;
+        }
+
+    private:
+        template<class K>
+        std::pair<bool, std::size_t> probe(K const& k, std::size_t h) const
+        {
+            return table.find(h, [&](std::size_t i)
+            {
+                return key(detail::id_access::make_vertex_id(i)) == k;
+            });
+        }
+        template<class K>
+        vertex_id make_vertex(K const& k)
+        {
+            return graph_t::add_vertex(k);
+        }
+        template<class K, class A, class ...Args>
+        vertex_id make_vertex(K const&, A&& a, Args&& ...args)
+        {
+            return graph_t::add_vertex(std::forward<A>(a), std::forward<Args>(args)...);
+        }
+
+        KeyF key_of;
+        HashT hash;
+        detail::vertex_key_table table;
+    };
+}
+
+#endif //GRAPH_KEYED_GRAPH_H
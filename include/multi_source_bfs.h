@@ -0,0 +1,208 @@
+#ifndef GRAPH_MULTI_SOURCE_BFS_H
+#define GRAPH_MULTI_SOURCE_BFS_H
+
+#include <algorithm>  //for std::fill, std::min, std::max
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <vector>     //for std::vector
+#include "Graph/include/bit_row.h"
+#include "Graph/include/csr_graph.h"
+
+/** \file
+ *  \brief 位并行的多源BFS(MS-BFS)及基于它的closeness/harmonic中心性.
+ *
+ * 一批(默认512个)源点同时进行BFS:每个顶点保存seen/visit/visit_next三个位集,第i位对应批中第i个源点.
+ * 每一层只扫描一次邻接表,对所有源点的前沿做逐字的与/或运算,
+ * 代替对每个源点各做一次BFS(后者每次都要重新扫描邻接表).
+ * 距离为沿邻接方向(有向图为出边)的边数.
+ * 图可以是csr_graph或compressed_graph(或其它以稠密编号提供vertex_count()与neighbors(v)的类型);
+ * multi_source_bfs即basic_multi_source_bfs<csr_graph>.
+ */
+
+namespace lzhlib
+{
+    template<class GraphT>
+    class basic_multi_source_bfs
+    {
+    public:
+        using index_t = typename GraphT::index_t;
+
+        explicit basic_multi_source_bfs(GraphT const& g, std::size_t batch_size = 512)   //batch_size须为64的正倍数
+            : g(&g), words((batch_size + 63) / 64)
+        {
+            assert(batch_size != 0 && batch_size % 64 == 0);
+        }
+
+        std::size_t batch_size() const noexcept
+        {
+            return words * 64;
+        }
+
+        /*
+         * 对sources逐批执行BFS.每个顶点v在某一批中第一次被一些源点到达时调用f(v, distance, first, reached),
+         * reached的第i位表示sources[first + i]在distance步时首次到达v(源点本身在distance为0时报告).
+         */
+        template<class F>
+        void run(std::vector<index_t> const& sources, F f)
+        {
+            std::size_t const n = g->vertex_count();
+            seen.assign(n * words, 0);
+            visit.assign(n * words, 0);
+            next.assign(n * words, 0);
+            for (std::size_t first = 0; first < sources.size(); first += batch_size())
+            {
+                std::size_t const last = std::min(sources.size(), first + batch_size());
+                std::fill(seen.begin(), seen.end(), 0);
+                std::fill(visit.begin(), visit.end(), 0);
+                for (std::size_t i = first; i != last; ++i)
+                {
+                    std::uint64_t const bit = std::uint64_t(1) << ((i - first) % 64);
+                    seen[sources[i] * words + (i - first) / 64] |= bit;
+                    visit[sources[i] * words + (i - first) / 64] |= bit;
+                }
+                for (index_t v = 0; v != n; ++v)
+                    if (any(visit, v))
+                        f(v, std::size_t(0), first, bit_row(&visit[v * words], words));
+                for (std::size_t distance = 1;; ++distance)
+                {
+                    std::fill(next.begin(), next.end(), 0);
+                    bool reached = false;
+                    for (index_t v = 0; v != n; ++v)
+                    {
+                        if (!any(visit, v))
+                            continue;
+                        std::uint64_t const* from = &visit[v * words];
+                        for (index_t u : g->neighbors(v))
+                        {
+                            std::uint64_t const* known = &seen[u * words];
+                            std::uint64_t* to = &next[u * words];
+                            for (std::size_t w = 0; w != words; ++w)
+                                to[w] |= from[w] & ~known[w];
+                        }
+                    }
+                    for (index_t u = 0; u != n; ++u)
+                    {
+                        if (!any(next, u))
+                            continue;
+                        reached = true;
+                        for (std::size_t w = 0; w != words; ++w)
+                            seen[u * words + w] |= next[u * words + w];
+                        f(u, distance, first, bit_row(&next[u * words], words));
+                    }
+                    if (!reached)
+                        break;
+                    visit.swap(next);
+                }
+            }
+        }
+
+    private:
+        bool any(std::vector<std::uint64_t> const& bits, index_t v) const noexcept
+        {
+            for (std::size_t w = 0; w != words; ++w)
+                if (bits[v * words + w] != 0)
+                    return true;
+            return false;
+        }
+
+        GraphT const* g;
+        std::size_t words;
+        std::vector<std::uint64_t> seen;
+        std::vector<std::uint64_t> visit;
+        std::vector<std::uint64_t> next;
+    };
+
+    using multi_source_bfs = basic_multi_source_bfs<csr_graph>;
+
+    namespace detail
+    {
+        struct reach_statistics
+        {
+            std::size_t reached = 0;        //不含源点本身
+            std::size_t distance_sum = 0;
+            double harmonic_sum = 0;
+            std::size_t eccentricity = 0;   //到达的最远距离
+        };
+
+        template<class GraphT>
+        std::vector<reach_statistics> reach_from(GraphT const& g, std::vector<csr_graph::index_t> const& sources)
+        {
+            std::vector<reach_statistics> ret(sources.size());
+            basic_multi_source_bfs<GraphT> bfs(g);
+            bfs.run(sources, [&](csr_graph::index_t, std::size_t distance, std::size_t first, bit_row reached)
+            {
+                if (distance == 0)
+                    return;
+                double const inverse = 1.0 / static_cast<double>(distance);
+                reached.for_each([&](std::size_t i)
+                {
+                    reach_statistics& s = ret[first + i];
+                    ++s.reached;
+                    s.distance_sum += distance;
+                    s.harmonic_sum += inverse;
+                    s.eccentricity = distance;
+                });
+            });
+            return ret;
+        }
+        template<class GraphT>
+        std::vector<csr_graph::index_t> all_vertices(GraphT const& g)
+        {
+            std::vector<csr_graph::index_t> ret(g.vertex_count());
+            for (csr_graph::index_t v = 0; v != ret.size(); ++v)
+                ret[v] = v;
+            return ret;
+        }
+    }
+
+    /*
+     * closeness(s) = (r / d) * (r / (n - 1)),r为s可到达的其它顶点数,d为到它们的距离之和.
+     * 图连通时即为通常的(n - 1) / d;不连通时按可到达的比例缩小(Wasserman-Faust).无法到达任何顶点时为0
+     */
+    template<class GraphT>
+    std::vector<double> closeness_centrality(GraphT const& g, std::vector<csr_graph::index_t> const& sources)
+    {
+        std::vector<double> ret;
+        ret.reserve(sources.size());
+        double const others = static_cast<double>(g.vertex_count()) - 1;
+        for (auto const& s : detail::reach_from(g, sources))
+            ret.push_back(s.reached == 0 ? 0 :
+                          static_cast<double>(s.reached) / static_cast<double>(s.distance_sum) * (static_cast<double>(s.reached) / others));
+        return ret;
+    }
+    template<class GraphT>
+    std::vector<double> closeness_centrality(GraphT const& g)     //按稠密编号
+    {
+        return closeness_centrality(g, detail::all_vertices(g));
+    }
+
+    //harmonic(s) = 所有可到达的其它顶点v的1 / d(s, v)之和(未归一化)
+    template<class GraphT>
+    std::vector<double> harmonic_centrality(GraphT const& g, std::vector<csr_graph::index_t> const& sources)
+    {
+        std::vector<double> ret;
+        ret.reserve(sources.size());
+        for (auto const& s : detail::reach_from(g, sources))
+            ret.push_back(s.harmonic_sum);
+        return ret;
+    }
+    template<class GraphT>
+    std::vector<double> harmonic_centrality(GraphT const& g)
+    {
+        return harmonic_centrality(g, detail::all_vertices(g));
+    }
+
+    //从每个源点出发能到达的最远距离(只计可到达的顶点)
+    template<class GraphT>
+    std::vector<std::size_t> eccentricity(GraphT const& g, std::vector<csr_graph::index_t> const& sources)
+    {
+        std::vector<std::size_t> ret;
+        ret.reserve(sources.size());
+        for (auto const& s : detail::reach_from(g, sources))
+            ret.push_back(s.eccentricity);
+        return ret;
+    }
+}
+
+#endif //GRAPH_MULTI_SOURCE_BFS_H
@@ -0,0 +1,84 @@
+#ifndef GRAPH_MUTATION_BATCH_H
+#define GRAPH_MUTATION_BATCH_H
+
+#include <cstddef>    //for std::size_t
+#include <utility>    //for std::forward
+#include <vector>     //for std::vector
+#include "Graph/include/value_column.h"
+#include "Graph/include/vertex_id.h"
+#include "Graph/include/edge_id.h"
+
+/** \file
+ *  \brief 批量修改图.
+ *
+ * mutation_batch只记录操作,不接触图;graph.apply(batch)时才按顶点分组统一执行:
+ * 先删除(被删除顶点的关联边一并删除),再添加.每个顶点的邻接集合只做一次有序合并或批量删除,
+ * 而不是每条边各做一次树操作.apply之前图不受影响,apply返回后图的不变式重新成立.
+ */
+
+namespace lzhlib
+{
+    template<class GraphT>
+    class mutation_batch
+    {
+    public:
+        using graph_t = GraphT;
+        using edge_value_t = typename detail::storable_value<typename graph_t::edge_value_t>::type;
+
+        struct edge_addition
+        {
+            vertex_id x;
+            vertex_id y;
+            edge_value_t value;
+        };
+
+        template<class ...Args>
+        void add_edge(vertex_id x, vertex_id y, Args&& ...args)  //x与y须在apply时仍然存在
+        {
+            additions_.push_back(edge_addition{x, y, edge_value_t(std::forward<Args>(args)...)});
+        }
+        void remove_edge(edge_id e)
+        {
+            removed_edges_.push_back(e);
+        }
+        void remove_vertex(vertex_id v)
+        {
+            removed_vertices_.push_back(v);
+        }
+
+        std::size_t size() const noexcept
+        {
+            return additions_.size() + removed_edges_.size() + removed_vertices_.size();
+        }
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+        void clear() noexcept
+        {
+            additions_.clear();
+            removed_edges_.clear();
+            removed_vertices_.clear();
+        }
+
+        std::vector<edge_addition>& additions() noexcept
+        {
+            return additions_;
+        }
+        std::vector<edge_id> const& removed_edges() const noexcept
+        {
+            return removed_edges_;
+        }
+        std::vector<vertex_id> const& removed_vertices() const noexcept
+        {
+            return removed_vertices_;
+        }
+
+    private:
+        std::vector<edge_addition> additions_;
+        std::vector<edge_id> removed_edges_;
+        std::vector<vertex_id> removed_vertices_;
+    };
+}
+
+#endif //GRAPH_MUTATION_BATCH_H
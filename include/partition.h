@@ -0,0 +1,573 @@
+#ifndef GRAPH_PARTITION_H
+#define GRAPH_PARTITION_H
+
+#include <algorithm>  //for std::sort, std::shuffle, std::lower_bound, std::max
+#include <cassert>    //for assert
+#include <cmath>      //for std::ceil
+#include <cstddef>    //for std::size_t, std::ptrdiff_t
+#include <cstdint>    //for std::uint64_t
+#include <numeric>    //for std::iota
+#include <queue>      //for std::priority_queue
+#include <random>     //for std::mt19937_64
+#include <utility>    //for std::pair
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/reorder.h"
+
+/** \file
+ *  \brief 多层图划分,以及按划分把图切成带ghost顶点的分片.
+ *
+ * partition_graph把顶点分成parts份,使每份的顶点数不超过平均值的(1 + imbalance)倍,并使跨份的边尽量少:
+ *  - 粗化: 反复做heavy-edge matching,把每对匹配的顶点合并为一个带权顶点,平行边合并为带权边,直到顶点足够少;
+ *  - 初始划分: 在最粗的图上从随机种子开始按连接度贪心地生长各份,取几次尝试中最好的一次;
+ *  - 细化: 逐层投影回细的图,每层做几趟k路贪心移动(标签传播式的FM):
+ *    把顶点移到连接权重最大的相邻一份,只接受减小割边或在割边不变时改善平衡的移动,超重的份可以付出代价移出顶点.
+ * 有向图按无向处理(出边与入边都视为相邻).结果由seed决定.
+ *
+ * make_shards为每一份建立一个graph_shard:本份拥有的顶点编号为[0, owned_count()),
+ * 它们的邻居中属于其它份的顶点作为ghost编号在其后,并记录各ghost的所属份及其在那一份中的编号,
+ * 以便并行的计算在各自的分片上只访问本地内存,再按ghost表交换边界上的数据.
+ */
+
+namespace lzhlib
+{
+    class graph_partition;
+    class graph_shard;
+    inline std::vector<graph_shard> make_shards(csr_graph const& g, graph_partition const& p);
+
+    class graph_partition
+    {
+    public:
+        using index_t = csr_graph::index_t;
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        graph_partition() = default;
+        //dense_part[v]为稠密编号v所在的份,须小于parts
+        graph_partition(csr_graph const& g, std::vector<index_t> const& dense_part, std::size_t parts)
+            : sizes(parts, 0)
+        {
+            for (index_t v = 0; v != g.vertex_count(); ++v)
+            {
+                std::size_t const i = detail::id_access::to_stock_id(g.vertex(v)).id();
+                if (i >= part_of.size())
+                {
+                    part_of.resize(i + 1, std::size_t(npos));
+                    local_of.resize(i + 1, std::size_t(npos));
+                }
+                part_of[i] = dense_part[v];
+                local_of[i] = sizes[dense_part[v]]++;
+                for (index_t u : g.neighbors(v))
+                    if (dense_part[u] != dense_part[v])
+                        ++cut;
+            }
+            if (!g.is_directed())
+                cut /= 2;
+        }
+
+        std::size_t part_count() const noexcept
+        {
+            return sizes.size();
+        }
+        std::size_t part(vertex_id v) const             //precondition: v在划分时存在
+        {
+            return part_of[detail::id_access::to_stock_id(v).id()];
+        }
+        std::size_t local_index(vertex_id v) const      //v在所属份中的编号(按稠密编号的顺序)
+        {
+            return local_of[detail::id_access::to_stock_id(v).id()];
+        }
+        std::size_t part_size(std::size_t p) const
+        {
+            return sizes[p];
+        }
+        std::size_t edge_cut() const noexcept           //两端不在同一份的边数(平行边分别计数)
+        {
+            return cut;
+        }
+
+    private:
+        std::vector<std::size_t> part_of;       //按顶点index,不存在的顶点为npos
+        std::vector<std::size_t> local_of;
+        std::vector<std::size_t> sizes;
+        std::size_t cut = 0;
+    };
+
+    class graph_shard
+    {
+    public:
+        using index_t = csr_graph::index_t;
+        static constexpr index_t npos = static_cast<index_t>(-1);
+
+        std::size_t part() const noexcept
+        {
+            return part_;
+        }
+        std::size_t vertex_count() const noexcept     //本份拥有的顶点与ghost顶点
+        {
+            return vertices.size();
+        }
+        std::size_t owned_count() const noexcept
+        {
+            return owned;
+        }
+        std::size_t ghost_count() const noexcept
+        {
+            return vertices.size() - owned;
+        }
+        bool is_ghost(index_t local) const noexcept
+        {
+            return local >= owned;
+        }
+
+        vertex_id vertex(index_t local) const
+        {
+            return vertices[local];
+        }
+        index_t local_index(vertex_id v) const        //不在分片中时为npos.O(log V)
+        {
+            std::size_t const i = detail::id_access::to_stock_id(v).id();
+            auto it = std::lower_bound(lookup.begin(), lookup.end(), std::make_pair(i, index_t(0)));
+            return it != lookup.end() && it->first == i ? it->second : index_t(npos);
+        }
+        std::size_t owner(index_t local) const        //顶点所属的份
+        {
+            return is_ghost(local) ? ghosts[local - owned].first : part_;
+        }
+        index_t remote_index(index_t local) const     //顶点在所属份的分片中的编号
+        {
+            return is_ghost(local) ? ghosts[local - owned].second : local;
+        }
+
+        //以下只对本份拥有的顶点可用:邻接方向与csr_graph相同,邻居为本地编号
+        std::size_t degree(index_t local) const
+        {
+            return offsets[local + 1] - offsets[local];
+        }
+        column_span<index_t const> neighbors(index_t local) const
+        {
+            return {targets.data() + offsets[local], degree(local)};
+        }
+        column_span<std::size_t const> edge_indices(index_t local) const     //与neighbors(local)一一对应的原图中边的index
+        {
+            return {edges.data() + offsets[local], degree(local)};
+        }
+
+    private:
+        friend std::vector<graph_shard> make_shards(csr_graph const& g, graph_partition const& p);
+
+        std::size_t part_ = 0;
+        std::size_t owned = 0;
+        std::vector<vertex_id> vertices;                    //本地编号 -> vertex_id
+        std::vector<std::pair<std::size_t, index_t>> ghosts;    //第i个ghost的(所属份, 在那一份中的编号)
+        std::vector<std::pair<std::size_t, index_t>> lookup;    //(顶点index, 本地编号),按index排序
+        std::vector<std::size_t> offsets;
+        std::vector<index_t> targets;
+        std::vector<std::size_t> edges;
+    };
+
+    namespace detail
+    {
+        //多层划分中的一层:顶点与边都带权的无向图,不含自环,平行边已合并
+        struct weighted_level
+        {
+            using index_t = csr_graph::index_t;
+
+            std::vector<std::size_t> offsets;
+            std::vector<index_t> targets;
+            std::vector<std::size_t> edge_weight;
+            std::vector<std::size_t> vertex_weight;
+
+            std::size_t vertex_count() const noexcept
+            {
+                return vertex_weight.size();
+            }
+        };
+
+        inline weighted_level finest_level(csr_graph const& g)
+        {
+            using index_t = csr_graph::index_t;
+            weighted_level ret;
+            std::size_t const n = g.vertex_count();
+            symmetric_neighbors adj(g);
+            ret.vertex_weight.assign(n, 1);
+            ret.offsets.reserve(n + 1);
+            ret.offsets.push_back(0);
+            std::vector<index_t> row;
+            for (index_t v = 0; v != n; ++v)
+            {
+                row.clear();
+                adj.for_each(v, [&](index_t u)
+                {
+                    if (u != v)
+                        row.push_back(u);
+                });
+                std::sort(row.begin(), row.end());
+                for (std::size_t k = 0; k != row.size(); ++k)
+                {
+                    if (k != 0 && row[k] == row[k - 1])
+                        ++ret.edge_weight.back();
+                    else
+                    {
+                        ret.targets.push_back(row[k]);
+                        ret.edge_weight.push_back(1);
+                    }
+                }
+                ret.offsets.push_back(ret.targets.size());
+            }
+            return ret;
+        }
+
+        //heavy-edge matching,返回细顶点 -> 粗顶点,coarse_count为粗顶点数
+        inline std::vector<csr_graph::index_t> heavy_edge_matching(weighted_level const& g, std::size_t max_weight,
+                                                                  std::mt19937_64& random, std::size_t& coarse_count)
+        {
+            using index_t = csr_graph::index_t;
+            std::size_t const n = g.vertex_count();
+            std::vector<index_t> order(n);
+            std::iota(order.begin(), order.end(), index_t(0));
+            std::shuffle(order.begin(), order.end(), random);
+            std::vector<index_t> map(n, index_t(csr_graph::npos));
+            coarse_count = 0;
+            for (index_t v : order)
+            {
+                if (map[v] != csr_graph::npos)
+                    continue;
+                index_t best = v;
+                std::size_t heaviest = 0;
+                for (std::size_t k = g.offsets[v]; k != g.offsets[v + 1]; ++k)
+                {
+                    index_t const u = g.targets[k];
+                    if (map[u] == csr_graph::npos && g.edge_weight[k] > heaviest &&
+                        g.vertex_weight[v] + g.vertex_weight[u] <= max_weight)
+                    {
+                        best = u;
+                        heaviest = g.edge_weight[k];
+                    }
+                }
+                map[v] = map[best] = static_cast<index_t>(coarse_count++);
+            }
+            return map;
+        }
+
+        inline weighted_level contract(weighted_level const& fine, std::vector<csr_graph::index_t> const& map, std::size_t coarse_count)
+        {
+            using index_t = csr_graph::index_t;
+            std::size_t const n = fine.vertex_count();
+            std::vector<std::size_t> first(coarse_count + 1, 0);
+            for (index_t c : map)
+                ++first[c + 1];
+            for (std::size_t c = 0; c != coarse_count; ++c)
+                first[c + 1] += first[c];
+            std::vector<index_t> members(n);
+            {
+                std::vector<std::size_t> next(first.begin(), first.end() - 1);
+                for (index_t v = 0; v != n; ++v)
+                    members[next[map[v]]++] = v;
+            }
+
+            weighted_level ret;
+            ret.vertex_weight.assign(coarse_count, 0);
+            ret.offsets.reserve(coarse_count + 1);
+            ret.offsets.push_back(0);
+            std::vector<std::size_t> where(coarse_count, std::size_t(-1));     //粗邻居在当前行中的位置
+            for (index_t c = 0; c != coarse_count; ++c)
+            {
+                std::size_t const row_start = ret.targets.size();
+                for (std::size_t m = first[c]; m != first[c + 1]; ++m)
+                {
+                    index_t const v = members[m];
+                    ret.vertex_weight[c] += fine.vertex_weight[v];
+                    for (std::size_t k = fine.offsets[v]; k != fine.offsets[v + 1]; ++k)
+                    {
+                        index_t const cu = map[fine.targets[k]];
+                        if (cu == c)
+                            continue;
+                        if (where[cu] != std::size_t(-1) && where[cu] >= row_start)
+                            ret.edge_weight[where[cu]] += fine.edge_weight[k];
+                        else
+                        {
+                            where[cu] = ret.targets.size();
+                            ret.targets.push_back(cu);
+                            ret.edge_weight.push_back(fine.edge_weight[k]);
+                        }
+                    }
+                }
+                ret.offsets.push_back(ret.targets.size());
+            }
+            return ret;
+        }
+
+        inline std::size_t cut_weight(weighted_level const& g, std::vector<csr_graph::index_t> const& part)
+        {
+            std::size_t ret = 0;
+            for (std::size_t v = 0; v != g.vertex_count(); ++v)
+                for (std::size_t k = g.offsets[v]; k != g.offsets[v + 1]; ++k)
+                    if (part[g.targets[k]] != part[v])
+                        ret += g.edge_weight[k];
+            return ret / 2;
+        }
+        inline std::size_t overweight(weighted_level const& g, std::vector<csr_graph::index_t> const& part,
+                                      std::size_t parts, std::size_t max_part)
+        {
+            std::vector<std::size_t> weight(parts, 0);
+            for (std::size_t v = 0; v != g.vertex_count(); ++v)
+                weight[part[v]] += g.vertex_weight[v];
+            std::size_t ret = 0;
+            for (std::size_t w : weight)
+                ret += w > max_part ? w - max_part : 0;
+            return ret;
+        }
+
+        //从随机种子出发,每次加入与当前份连接权重最大的顶点,直到达到平均重量;剩余的顶点归入最后一份
+        inline std::vector<csr_graph::index_t> grow_partition(weighted_level const& g, std::size_t parts, std::size_t max_part,
+                                                             std::mt19937_64& random)
+        {
+            using index_t = csr_graph::index_t;
+            std::size_t const n = g.vertex_count();
+            std::size_t total = 0;
+            for (std::size_t w : g.vertex_weight)
+                total += w;
+            std::size_t const target = (total + parts - 1) / parts;
+            index_t const unassigned = static_cast<index_t>(parts);
+            std::vector<index_t> part(n, unassigned);
+            std::vector<index_t> seeds(n);
+            std::iota(seeds.begin(), seeds.end(), index_t(0));
+            std::shuffle(seeds.begin(), seeds.end(), random);
+            std::size_t next_seed = 0;
+            std::vector<std::size_t> connection(n, 0);
+            std::vector<index_t> connection_part(n, unassigned);
+            for (index_t p = 0; p + 1 < parts; ++p)
+            {
+                std::priority_queue<std::pair<std::size_t, index_t>> frontier;
+                std::size_t weight = 0;
+                while (weight < target)
+                {
+                    if (frontier.empty())
+                    {
+                        while (next_seed != n && part[seeds[next_seed]] != unassigned)
+                            ++next_seed;
+                        if (next_seed == n)
+                            break;
+                        frontier.emplace(0, seeds[next_seed++]);   //放不下的种子不再重试
+                    }
+                    index_t const v = frontier.top().second;
+                    frontier.pop();
+                    if (part[v] != unassigned || weight + g.vertex_weight[v] > max_part)
+                        continue;
+                    part[v] = p;
+                    weight += g.vertex_weight[v];
+                    for (std::size_t k = g.offsets[v]; k != g.offsets[v + 1]; ++k)
+                    {
+                        index_t const u = g.targets[k];
+                        if (part[u] != unassigned)
+                            continue;
+                        if (connection_part[u] != p)
+                        {
+                            connection_part[u] = p;
+                            connection[u] = 0;
+                        }
+                        connection[u] += g.edge_weight[k];
+                        frontier.emplace(connection[u], u);
+                    }
+                }
+            }
+            for (index_t& p : part)
+                if (p == unassigned)
+                    p = static_cast<index_t>(parts - 1);
+            return part;
+        }
+
+        //k路贪心细化,每趟按随机顺序检查所有顶点,没有顶点移动时提前结束
+        inline void refine_partition(weighted_level const& g, std::vector<csr_graph::index_t>& part, std::size_t parts,
+                                     std::size_t max_part, std::size_t passes, std::mt19937_64& random)
+        {
+            using index_t = csr_graph::index_t;
+            std::size_t const n = g.vertex_count();
+            std::vector<std::size_t> weight(parts, 0);
+            for (std::size_t v = 0; v != n; ++v)
+                weight[part[v]] += g.vertex_weight[v];
+            std::vector<index_t> order(n);
+            std::iota(order.begin(), order.end(), index_t(0));
+            std::vector<std::size_t> connection(parts, 0);
+            std::vector<index_t> touched;
+            for (std::size_t pass = 0; pass != passes; ++pass)
+            {
+                std::shuffle(order.begin(), order.end(), random);
+                std::size_t moved = 0;
+                for (index_t v : order)
+                {
+                    index_t const p = part[v];
+                    std::size_t const w = g.vertex_weight[v];
+                    touched.clear();
+                    for (std::size_t k = g.offsets[v]; k != g.offsets[v + 1]; ++k)
+                    {
+                        index_t const q = part[g.targets[k]];
+                        if (connection[q] == 0)
+                            touched.push_back(q);
+                        connection[q] += g.edge_weight[k];
+                    }
+                    bool const over = weight[p] > max_part;
+                    if (over)                       //超重时也考虑最轻的一份,即使v与它不相邻
+                    {
+                        index_t lightest = 0;
+                        for (index_t q = 1; q != parts; ++q)
+                            if (weight[q] < weight[lightest])
+                                lightest = q;
+                        if (connection[lightest] == 0)
+                            touched.push_back(lightest);
+                    }
+                    auto const internal = static_cast<std::ptrdiff_t>(connection[p]);
+                    index_t best = p;
+                    std::ptrdiff_t best_gain = 0;
+                    for (index_t q : touched)
+                    {
+                        if (q == p || weight[q] + w > max_part)
+                            continue;
+                        std::ptrdiff_t const gain = static_cast<std::ptrdiff_t>(connection[q]) - internal;
+                        if (best == p || gain > best_gain || (gain == best_gain && weight[q] < weight[best]))
+                        {
+                            best = q;
+                            best_gain = gain;
+                        }
+                    }
+                    for (index_t q : touched)
+                        connection[q] = 0;
+                    connection[p] = 0;
+                    if (best == p)
+                        continue;
+                    if (best_gain > 0 || over || (best_gain == 0 && weight[best] + w < weight[p]))
+                    {
+                        part[v] = best;
+                        weight[p] -= w;
+                        weight[best] += w;
+                        ++moved;
+                    }
+                }
+                if (moved == 0)
+                    break;
+            }
+        }
+    }
+
+    /*
+     * 返回的划分中每份的顶点数不超过ceil(n / parts * (1 + imbalance)),除非图的结构使贪心过程无法达到(此时尽量接近).
+     * 代价约为O((V + E) * (粗化层数 + 细化趟数)).
+     */
+    inline graph_partition partition_graph(csr_graph const& g, std::size_t parts, double imbalance = 0.03, std::uint64_t seed = 0)
+    {
+        using index_t = csr_graph::index_t;
+        assert(parts != 0);
+        std::size_t const n = g.vertex_count();
+        if (parts == 1 || n == 0)
+            return graph_partition(g, std::vector<index_t>(n, 0), parts);
+
+        std::mt19937_64 random(seed);
+        std::size_t const max_part = static_cast<std::size_t>(std::ceil(static_cast<double>(n) / static_cast<double>(parts) * (1 + imbalance)));
+        std::size_t const coarsen_to = std::max<std::size_t>(20 * parts, 64);
+        std::size_t const max_vertex_weight = std::max<std::size_t>(1, 3 * n / (2 * coarsen_to));
+        std::size_t const refine_passes = 8;
+
+        std::vector<detail::weighted_level> levels;
+        std::vector<std::vector<index_t>> maps;
+        levels.push_back(detail::finest_level(g));
+        while (levels.back().vertex_count() > coarsen_to)
+        {
+            std::size_t coarse_count;
+            std::vector<index_t> map = detail::heavy_edge_matching(levels.back(), max_vertex_weight, random, coarse_count);
+            if (coarse_count * 20 > levels.back().vertex_count() * 19)  //几乎无法再匹配
+                break;
+            levels.push_back(detail::contract(levels.back(), map, coarse_count));
+            maps.push_back(std::move(map));
+        }
+
+        std::vector<index_t> part;
+        std::pair<std::size_t, std::size_t> best_score;     //(超重的量, 割边权重)
+        for (int attempt = 0; attempt != 4; ++attempt)
+        {
+            std::vector<index_t> candidate = detail::grow_partition(levels.back(), parts, max_part, random);
+            detail::refine_partition(levels.back(), candidate, parts, max_part, refine_passes, random);
+            std::pair<std::size_t, std::size_t> score{detail::overweight(levels.back(), candidate, parts, max_part),
+                                                     detail::cut_weight(levels.back(), candidate)};
+            if (part.empty() || score < best_score)
+            {
+                part.swap(candidate);
+                best_score = score;
+            }
+        }
+        for (std::size_t l = maps.size(); l-- != 0;)
+        {
+            std::vector<index_t> finer(maps[l].size());
+            for (std::size_t v = 0; v != finer.size(); ++v)
+                finer[v] = part[maps[l][v]];
+            part.swap(finer);
+            detail::refine_partition(levels[l], part, parts, max_part, refine_passes, random);
+        }
+        return graph_partition(g, part, parts);
+    }
+    template<class GraphT>
+    graph_partition partition_graph(GraphT const& g, std::size_t parts, double imbalance = 0.03, std::uint64_t seed = 0)
+    {
+        return partition_graph(csr_graph(g), parts, imbalance, seed);
+    }
+
+    //p须由同一个图(或其csr_graph)得到
+    inline std::vector<graph_shard> make_shards(csr_graph const& g, graph_partition const& p)
+    {
+        using index_t = csr_graph::index_t;
+        std::size_t const n = g.vertex_count();
+        std::vector<graph_shard> ret(p.part_count());
+        std::vector<std::vector<index_t>> members(p.part_count());
+        for (index_t v = 0; v != n; ++v)
+            members[p.part(g.vertex(v))].push_back(v);
+        std::vector<index_t> local(n, index_t(graph_shard::npos));     //当前分片中的本地编号
+        for (std::size_t q = 0; q != ret.size(); ++q)
+        {
+            graph_shard& s = ret[q];
+            s.part_ = q;
+            s.owned = members[q].size();
+            for (index_t v : members[q])
+            {
+                local[v] = static_cast<index_t>(s.vertices.size());
+                s.vertices.push_back(g.vertex(v));
+            }
+            s.offsets.reserve(s.owned + 1);
+            s.offsets.push_back(0);
+            std::vector<index_t> ghost_dense;
+            for (index_t v : members[q])
+            {
+                auto neighbors = g.neighbors(v);
+                auto edges = g.edge_indices(v);
+                for (std::size_t k = 0; k != neighbors.size(); ++k)
+                {
+                    index_t const u = neighbors[k];
+                    if (local[u] == graph_shard::npos)
+                    {
+                        local[u] = static_cast<index_t>(s.vertices.size());
+                        s.vertices.push_back(g.vertex(u));
+                        s.ghosts.emplace_back(p.part(g.vertex(u)), static_cast<index_t>(p.local_index(g.vertex(u))));
+                        ghost_dense.push_back(u);
+                    }
+                    s.targets.push_back(local[u]);
+                    s.edges.push_back(edges[k]);
+                }
+                s.offsets.push_back(s.targets.size());
+            }
+            s.lookup.reserve(s.vertices.size());
+            for (index_t i = 0; i != s.vertices.size(); ++i)
+                s.lookup.emplace_back(detail::id_access::to_stock_id(s.vertices[i]).id(), i);
+            std::sort(s.lookup.begin(), s.lookup.end());
+            for (index_t v : members[q])
+                local[v] = graph_shard::npos;
+            for (index_t u : ghost_dense)
+                local[u] = graph_shard::npos;
+        }
+        return ret;
+    }
+    template<class GraphT>
+    std::vector<graph_shard> make_shards(GraphT const& g, graph_partition const& p)
+    {
+        return make_shards(csr_graph(g), p);
+    }
+}
+
+#endif //GRAPH_PARTITION_H
@@ -0,0 +1,193 @@
+#ifndef GRAPH_PERSISTENT_ARRAY_H
+#define GRAPH_PERSISTENT_ARRAY_H
+
+#include <array>      //for std::array
+#include <atomic>     //for std::atomic
+#include <bitset>     //for std::bitset
+#include <cstddef>    //for std::size_t
+#include <memory>     //for std::shared_ptr, std::make_shared
+#include <type_traits>//for std::remove_const_t, std::remove_reference_t
+#include <utility>    //for std::move
+#include <vector>     //for std::vector
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        /*
+         * 分块的写时复制数组.拷贝只复制一个指针(O(1)),副本之间共享所有块;
+         * 之后对某个元素的写入只复制该元素所在的块(以及一次块表),未被修改的块继续共享.
+         * 是否需要复制不看引用计数(use_count()的读取与其它线程释放引用之间没有同步),而是看独占标记:
+         * 块表被拷贝时标记为共享,此后不再被修改;复制出的新块表与新块不独占其中任何块与元素,
+         * 只有本副本复制或新建的块与元素才标记为独占并可以原地修改.
+         * 因此被多个副本引用的块表,块,元素都不会被写入,不同副本可以在不同线程中同时读写;
+         * 同一个副本的写操作必须由同一线程完成.
+         */
+        template<class T, std::size_t ChunkBits = 6>
+        class persistent_array
+        {
+        public:
+            static constexpr std::size_t chunk_size = std::size_t(1) << ChunkBits;
+
+            persistent_array()
+                : table(std::make_shared<table_t>())
+            {}
+            persistent_array(persistent_array const& other)
+                : table(other.table), size_(other.size_)
+            {
+                table->shared.store(true, std::memory_order_relaxed);
+            }
+            persistent_array(persistent_array&&) = default;
+            persistent_array& operator=(persistent_array const& other)
+            {
+                other.table->shared.store(true, std::memory_order_relaxed);
+                table = other.table;
+                size_ = other.size_;
+                return *this;
+            }
+            persistent_array& operator=(persistent_array&&) = default;
+
+            std::size_t size() const noexcept
+            {
+                return size_;
+            }
+            T const& operator[](std::size_t i) const
+            {
+                return table->chunks[i >> ChunkBits]->items[i & mask];
+            }
+            //在本副本中独占i所在的块,再返回其中的元素.写入的值须为本副本独占(如新建的记录),
+            //不能借此修改元素指向的可能被共享的对象,那应使用own_pointee
+            T& mutable_at(std::size_t i)
+            {
+                chunk_t& chunk = own_chunk(i >> ChunkBits);
+                chunk.owned.set(i & mask);
+                return chunk.items[i & mask];
+            }
+            //T为std::shared_ptr时:返回本副本独占的*(*this)[i],尚未独占时先复制一份.precondition: (*this)[i]不为空
+            auto& own_pointee(std::size_t i)
+            {
+                chunk_t& chunk = own_chunk(i >> ChunkBits);
+                T& p = chunk.items[i & mask];
+                if (!chunk.owned.test(i & mask))
+                {
+                    using pointee_t = std::remove_const_t<std::remove_reference_t<decltype(*p)>>;
+                    p = std::make_shared<pointee_t>(static_cast<pointee_t const&>(*p));
+                    chunk.owned.set(i & mask);
+                }
+                return *p;
+            }
+            void push_back(T value)
+            {
+                if ((size_ & mask) == 0)
+                {
+                    table_t& t = own_table();
+                    t.chunks.push_back(std::make_shared<chunk_t>());
+                    t.owned.push_back(true);
+                }
+                mutable_at(size_) = std::move(value);
+                ++size_;
+            }
+            std::size_t chunk_count() const noexcept
+            {
+                return table->chunks.size();
+            }
+
+        private:
+            static constexpr std::size_t mask = chunk_size - 1;
+
+            struct chunk_t
+            {
+                chunk_t() = default;
+                explicit chunk_t(std::array<T, chunk_size> const& items)
+                    : items(items)
+                {}
+
+                std::array<T, chunk_size> items;
+                std::bitset<chunk_size> owned;      //本块独占的元素
+            };
+            struct table_t
+            {
+                table_t() = default;
+                explicit table_t(std::vector<std::shared_ptr<chunk_t>> const& chunks)
+                    : chunks(chunks), owned(chunks.size(), false)
+                {}
+
+                std::vector<std::shared_ptr<chunk_t>> chunks;
+                std::vector<bool> owned;            //本表独占的块
+                std::atomic<bool> shared{false};    //已被多个副本引用;一经设置不再清除
+            };
+
+            table_t& own_table()
+            {
+                if (table->shared.load(std::memory_order_relaxed))
+                    table = std::make_shared<table_t>(table->chunks);
+                return *table;
+            }
+            chunk_t& own_chunk(std::size_t c)
+            {
+                table_t& t = own_table();
+                if (!t.owned[c])
+                {
+                    t.chunks[c] = std::make_shared<chunk_t>(t.chunks[c]->items);
+                    t.owned[c] = true;
+                }
+                return *t.chunks[c];
+            }
+
+            std::shared_ptr<table_t> table;
+            std::size_t size_ = 0;
+        };
+
+        /*
+         * 不可变链表实现的栈.拷贝为O(1),副本之间共享其余部分;push/pop只影响本副本.
+         */
+        template<class T>
+        class persistent_stack
+        {
+        public:
+            persistent_stack() = default;
+            persistent_stack(persistent_stack const&) = default;
+            persistent_stack(persistent_stack&&) = default;
+            persistent_stack& operator=(persistent_stack const&) = default;
+            persistent_stack& operator=(persistent_stack&&) = default;
+            ~persistent_stack()
+            {
+                //逐个释放结点,避免长链递归析构.结点可能被其它线程中的副本共享,因此只读取而不修改它;
+                //use_count()只用来判断何时可以停止,读到过期的值也只是多走或少走几步
+                while (head && head.use_count() == 1)
+                {
+                    std::shared_ptr<node> next = head->next;
+                    head = std::move(next);
+                }
+            }
+
+            bool empty() const noexcept
+            {
+                return head == nullptr;
+            }
+            T const& top() const
+            {
+                return head->value;
+            }
+            void push(T value)
+            {
+                head = std::make_shared<node>(node{std::move(value), std::move(head)});
+            }
+            void pop()
+            {
+                head = head->next;
+            }
+
+        private:
+            struct node
+            {
+                T value;
+                std::shared_ptr<node> next;
+            };
+
+            std::shared_ptr<node> head;
+        };
+    }
+}
+
+#endif //GRAPH_PERSISTENT_ARRAY_H
@@ -0,0 +1,372 @@
+#ifndef GRAPH_PERSISTENT_GRAPH_H
+#define GRAPH_PERSISTENT_GRAPH_H
+
+#include <algorithm>  //for std::lower_bound, std::find_if
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <memory>     //for std::shared_ptr, std::make_shared
+#include <type_traits>    //for std::is_same, std::integral_constant
+#include <utility>    //for std::pair, std::forward, std::move
+#include <vector>     //for std::vector
+#include "Graph/include/vertex.h"
+#include "Graph/include/edge.h"
+#include "Graph/include/id_access.h"
+#include "Graph/include/persistent_array.h"
+#include "Graph/include/value_column.h"
+
+/** \file
+ *  \brief 可以O(1)复制的无向图.
+ *
+ * 顶点与边保存在分块的写时复制数组中,每个顶点的邻接表与值是一个共享的记录.
+ * 复制(或fork())只复制几个指针,副本之间共享全部数据;之后每个副本的修改只复制被修改的块与记录,
+ * 因此从同一个图派生出的大量略有不同的副本只为各自的修改付出内存与时间.
+ * graph_snapshot是其只读部分,也用作concurrent_undirected_graph发布的版本.
+ * 是否复制由persistent_array的独占标记决定,而不是引用计数,被多个副本引用的块与记录从不被原地修改,
+ * 因此不同副本可以在不同线程中同时修改;同一个副本不能同时被多个线程修改.
+ */
+
+namespace lzhlib
+{
+    namespace detail
+    {
+        template<class VertexValueT>
+        struct snapshot_vertex
+        {
+            template<class ...Args>
+            explicit snapshot_vertex(Args&& ...args)
+                : value(std::forward<Args>(args)...)
+            {}
+
+            typename storable_value<VertexValueT>::type value;
+            std::vector<edge_ref> edges;   //sorted by edge_id
+        };
+
+        template<class EdgeValueT>
+        struct snapshot_edge
+        {
+            template<class ...Args>
+            explicit snapshot_edge(std::pair<vertex_id, vertex_id> v, Args&& ...args)
+                : vertices(v), value(std::forward<Args>(args)...)
+            {}
+
+            std::pair<vertex_id, vertex_id> vertices;
+            typename storable_value<EdgeValueT>::type value;
+        };
+    }
+
+    template<class VertexValueT, class EdgeValueT>
+    class concurrent_undirected_graph;
+
+    template<class VertexValueT, class EdgeValueT>
+    class graph_snapshot            //某一版本的图,只读
+    {
+        template<class, class>
+        friend
+        class concurrent_undirected_graph;
+
+    public:
+        using vertex_value_t = typename detail::storable_value<VertexValueT>::type;
+        using edge_value_t = typename detail::storable_value<EdgeValueT>::type;
+        using edge_ref_t = detail::edge_ref;
+        using pair_t = std::pair<vertex_id, vertex_id>;
+
+        static constexpr bool is_directed = false;
+
+        std::uint64_t version() const noexcept
+        {
+            return version_;
+        }
+
+        bool contains(vertex_id v) const
+        {
+            std::size_t i = index(v);
+            return i < vertices.size() && vertices[i] != nullptr;
+        }
+        bool contains(edge_id e) const
+        {
+            std::size_t i = index(e);
+            return i < edges.size() && edges[i] != nullptr;
+        }
+
+        vertex_value_t const& value(vertex_id v) const
+        {
+            return get_vertex(v).value;
+        }
+        edge_value_t const& value(edge_id e) const
+        {
+            return get_edge(e).value;
+        }
+        pair_t associated_vertices(edge_id e) const
+        {
+            return get_edge(e).vertices;
+        }
+        std::vector<edge_ref_t> const& associated_edges(vertex_id v) const  //按edge_id排序
+        {
+            return get_vertex(v).edges;
+        }
+        std::vector<vertex_id> neighbors(vertex_id v) const
+        {
+            auto const& edges = associated_edges(v);
+            std::vector<vertex_id> ret;
+            ret.reserve(edges.size());
+            for (edge_ref_t e : edges)
+                ret.push_back(e.opposite_vertex());
+            return ret;
+        }
+        bool associated(vertex_id v, edge_id e) const
+        {
+            auto const& edges = associated_edges(v);
+            auto i = std::lower_bound(edges.begin(), edges.end(), e);
+            return i != edges.end() && i->edge() == e;
+        }
+        bool adjacent(vertex_id x, vertex_id y) const
+        {
+            return find_edge(x, y) != nullptr;
+        }
+        edge_id get_edge(vertex_id x, vertex_id y) const
+        {
+            edge_ref_t const* e = find_edge(x, y);
+            if (e == nullptr)
+                throw exceptions::require_edge_that_does_not_exist();
+            return e->edge();
+        }
+
+        vertex_id first_vertex() const
+        {
+            return vertex_at_or_after(0);
+        }
+        bool vertex_end(vertex_id v) const
+        {
+            return index(v) == vertices.size();
+        }
+        vertex_id next_vertex(vertex_id v) const
+        {
+            return vertex_at_or_after(index(v) + 1);
+        }
+
+        std::size_t vertex_count() const noexcept
+        {
+            return vertex_count_;
+        }
+        std::size_t edge_count() const noexcept
+        {
+            return edge_count_;
+        }
+        std::size_t vertex_index_bound() const noexcept  //所有有效顶点的index都小于此值
+        {
+            return vertices.size();
+        }
+        std::size_t edge_index_bound() const noexcept
+        {
+            return edges.size();
+        }
+        std::size_t index(vertex_id v) const noexcept
+        {
+            return detail::id_access::to_stock_id(v).id();
+        }
+        std::size_t index(edge_id e) const noexcept
+        {
+            return detail::id_access::to_stock_id(e).id();
+        }
+
+    protected:
+        using vertex_record = detail::snapshot_vertex<VertexValueT>;
+        using edge_record = detail::snapshot_edge<EdgeValueT>;
+
+        vertex_record const& get_vertex(vertex_id v) const
+        {
+            return *vertices[index(v)];
+        }
+        edge_record const& get_edge(edge_id e) const
+        {
+            return *edges[index(e)];
+        }
+        edge_ref_t const* find_edge(vertex_id x, vertex_id y) const
+        {
+            auto const& xs = associated_edges(x);
+            auto const& ys = associated_edges(y);
+            auto const& smaller = xs.size() <= ys.size() ? xs : ys;
+            vertex_id other = xs.size() <= ys.size() ? y : x;
+            auto i = std::find_if(smaller.begin(), smaller.end(),
+                                  [other](edge_ref_t e) { return e.is_connected(other); });
+            return i == smaller.end() ? nullptr : &*i;
+        }
+        vertex_id vertex_at_or_after(std::size_t i) const
+        {
+            while (i != vertices.size() && vertices[i] == nullptr)
+                ++i;
+            return detail::id_access::make_vertex_id(i);
+        }
+
+        detail::persistent_array<std::shared_ptr<vertex_record>> vertices;   //nullptr marks a free slot
+        detail::persistent_array<std::shared_ptr<edge_record>> edges;
+        std::size_t vertex_count_ = 0;
+        std::size_t edge_count_ = 0;
+        std::uint64_t version_ = 0;
+    };
+
+    template<class VertexValueT, class EdgeValueT>
+    class persistent_undirected_graph : public graph_snapshot<VertexValueT, EdgeValueT>
+    {
+    public:
+        using base = graph_snapshot<VertexValueT, EdgeValueT>;
+        using vertex_value_t = typename base::vertex_value_t;
+        using edge_value_t = typename base::edge_value_t;
+        using edge_ref_t = typename base::edge_ref_t;
+        using pair_t = typename base::pair_t;
+
+        persistent_undirected_graph() = default;
+
+        //从undirected_graph(或其它具有相同只读接口的无向图)复制,顶点与边的id保持不变.O(V+E)
+        template<class GraphT>
+        explicit persistent_undirected_graph(GraphT const& g)
+        {
+            static_assert(!GraphT::is_directed, "persistent_undirected_graph can only be built from an undirected graph");
+            for (std::size_t i = 0; i != g.vertex_index_bound(); ++i)
+                this->vertices.push_back(nullptr);
+            for (std::size_t i = 0; i != g.edge_index_bound(); ++i)
+                this->edges.push_back(nullptr);
+            for (auto v = g.first_vertex(); !g.vertex_end(v); v = g.next_vertex(v))
+            {
+                auto record = std::make_shared<vertex_record>(source_value(g, v, is_empty<vertex_value_t>{}));
+                for (edge_ref_t e : g.associated_edges(v))
+                {
+                    record->edges.push_back(e);
+                    auto& edge = this->edges.mutable_at(g.index(e.edge()));
+                    if (edge == nullptr)
+                    {
+                        edge = std::make_shared<edge_record>(g.associated_vertices(e.edge()),
+                                                             source_value(g, e.edge(), is_empty<edge_value_t>{}));
+                        ++this->edge_count_;
+                    }
+                }
+                this->vertices.mutable_at(g.index(v)) = std::move(record);
+                ++this->vertex_count_;
+            }
+            for (std::size_t i = this->vertices.size(); i-- != 0;)
+                if (this->vertices[i] == nullptr)
+                    free_vertices.push(i);
+            for (std::size_t i = this->edges.size(); i-- != 0;)
+                if (this->edges[i] == nullptr)
+                    free_edges.push(i);
+        }
+
+        persistent_undirected_graph fork() const    //O(1),与拷贝构造相同
+        {
+            return *this;
+        }
+
+        template<class ...Args>
+        vertex_id add_vertex(Args&& ...args)
+        {
+            auto record = std::make_shared<vertex_record>(std::forward<Args>(args)...);
+            std::size_t i = take_slot(this->vertices, free_vertices, std::move(record));
+            ++this->vertex_count_;
+            return detail::id_access::make_vertex_id(i);
+        }
+        void remove_vertex(vertex_id v)
+        {
+            std::size_t i = this->index(v);
+            std::vector<edge_ref_t> edges = this->get_vertex(v).edges;
+            for (edge_ref_t e : edges)
+            {
+                if (!(e.opposite_vertex() == v))
+                    erase_ref(own_vertex(this->index(e.opposite_vertex())), e.edge());
+                release_edge(e.edge());
+            }
+            this->vertices.mutable_at(i) = nullptr;
+            free_vertices.push(i);
+            --this->vertex_count_;
+        }
+
+        template<class ...Args>
+        edge_id add_edge(vertex_id x, vertex_id y, Args&& ...args)
+        {
+            auto record = std::make_shared<edge_record>(pair_t{x, y}, std::forward<Args>(args)...);
+            edge_id e = detail::id_access::make_edge_id(take_slot(this->edges, free_edges, std::move(record)));
+            insert_ref(own_vertex(this->index(x)), {e, y});
+            if (!(x == y))
+                insert_ref(own_vertex(this->index(y)), {e, x});
+            ++this->edge_count_;
+            return e;
+        }
+        void remove_edge(vertex_id x, vertex_id y)
+        {
+            remove_edge(this->get_edge(x, y));
+        }
+        void remove_edge(edge_id e)
+        {
+            pair_t vertices = this->associated_vertices(e);
+            erase_ref(own_vertex(this->index(vertices.first)), e);
+            if (!(vertices.first == vertices.second))
+                erase_ref(own_vertex(this->index(vertices.second)), e);
+            release_edge(e);
+        }
+
+        using base::value;
+        vertex_value_t& value(vertex_id v)
+        {
+            return own_vertex(this->index(v)).value;
+        }
+        edge_value_t& value(edge_id e)
+        {
+            return this->edges.own_pointee(this->index(e)).value;
+        }
+
+    private:
+        using vertex_record = typename base::vertex_record;
+        using edge_record = typename base::edge_record;
+        template<class ValueT>
+        using is_empty = std::is_same<ValueT, detail::empty_value>;
+
+        template<class GraphT, class IdT>
+        static detail::empty_value source_value(GraphT const&, IdT, std::true_type)
+        {
+            return {};
+        }
+        template<class GraphT, class IdT>
+        static auto const& source_value(GraphT const& g, IdT id, std::false_type)
+        {
+            return g.value(id);
+        }
+
+        template<class RecordT>
+        static std::size_t take_slot(detail::persistent_array<std::shared_ptr<RecordT>>& slots,
+                                     detail::persistent_stack<std::size_t>& free_list, std::shared_ptr<RecordT> record)
+        {
+            if (free_list.empty())
+            {
+                slots.push_back(std::move(record));
+                return slots.size() - 1;
+            }
+            std::size_t i = free_list.top();
+            free_list.pop();
+            slots.mutable_at(i) = std::move(record);
+            return i;
+        }
+        vertex_record& own_vertex(std::size_t i)    //copy-on-write: 可能被其它副本或已发布版本引用的顶点先复制再修改
+        {
+            return this->vertices.own_pointee(i);
+        }
+        static void insert_ref(vertex_record& v, edge_ref_t r)
+        {
+            v.edges.insert(std::lower_bound(v.edges.begin(), v.edges.end(), r), r);
+        }
+        static void erase_ref(vertex_record& v, edge_id e)
+        {
+            v.edges.erase(std::lower_bound(v.edges.begin(), v.edges.end(), e));
+        }
+        void release_edge(edge_id e)
+        {
+            std::size_t i = this->index(e);
+            this->edges.mutable_at(i) = nullptr;
+            free_edges.push(i);
+            --this->edge_count_;
+        }
+
+        detail::persistent_stack<std::size_t> free_vertices;
+        detail::persistent_stack<std::size_t> free_edges;
+    };
+}
+
+#endif //GRAPH_PERSISTENT_GRAPH_H
@@ -0,0 +1,327 @@
+#ifndef GRAPH_RANDOM_WALK_H
+#define GRAPH_RANDOM_WALK_H
+
+#include <algorithm>  //for std::max, std::min, std::binary_search, std::find
+#include <atomic>     //for std::atomic
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint64_t
+#include <mutex>      //for std::mutex, std::lock_guard
+#include <ostream>    //for std::ostream
+#include <random>     //for std::mt19937_64, std::uniform_int_distribution, std::uniform_real_distribution
+#include <thread>     //for std::thread
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief 在csr_graph上并行产生随机游走(均匀,带权,node2vec).
+ *
+ * 带权游走为每个顶点的邻接项预先建立alias表(Vose),每一步O(1)地按权重取下一个顶点.
+ * node2vec(p, q)的二阶转移概率依赖上一个顶点,不为每条边建表,而是先按一阶概率取候选x,
+ * 再以bias(x) / max_bias接受:x为上一个顶点时bias为1/p,与上一个顶点相邻时为1,否则为1/q.
+ * 相邻判断在上一个顶点的有序邻居中二分查找.
+ *
+ * 游走按块(chunk)分给线程,每块有自己的随机数引擎,种子只由seed与块的编号决定,因此结果与线程数无关.
+ * 每次游走写入长度固定为length的一段,遇到没有出边的顶点时提前结束,其余位置为npos;整个过程不为单次游走分配内存.
+ * 游走的内容为csr_graph的稠密编号.
+ */
+
+namespace lzhlib
+{
+    //所有游走首尾相接地存放,每段长度相同
+    class walk_buffer
+    {
+    public:
+        using index_t = csr_graph::index_t;
+        static constexpr index_t npos = csr_graph::npos;
+
+        walk_buffer() = default;
+        walk_buffer(std::size_t walk_count, std::size_t walk_length)
+            : length(walk_length), steps(walk_count * walk_length, index_t(npos))
+        {}
+
+        std::size_t walk_count() const noexcept
+        {
+            return length == 0 ? 0 : steps.size() / length;
+        }
+        std::size_t walk_length() const noexcept
+        {
+            return length;
+        }
+        column_span<index_t const> walk(std::size_t i) const    //不含提前结束后的npos
+        {
+            index_t const* first = steps.data() + i * length;
+            return {first, static_cast<std::size_t>(std::find(first, first + length, index_t(npos)) - first)};
+        }
+        index_t* data() noexcept
+        {
+            return steps.data();
+        }
+        index_t const* data() const noexcept
+        {
+            return steps.data();
+        }
+
+    private:
+        std::size_t length = 0;
+        std::vector<index_t> steps;
+    };
+
+    class random_walker
+    {
+    public:
+        using index_t = csr_graph::index_t;
+        static constexpr index_t npos = csr_graph::npos;
+
+        explicit random_walker(csr_graph const& g)      //均匀游走.g须比random_walker存在得更久
+            : g(&g)
+        {}
+        //带权游走:weight(graph.value(e))为边e的权重,须非负;csr须由graph构造
+        template<class GraphT, class WeightF>
+        random_walker(GraphT const& graph, csr_graph const& csr, WeightF weight)
+            : g(&csr), probability(csr.entry_count()), weights(csr.entry_count()), alias(csr.entry_count())
+        {
+            std::vector<double> w;
+            std::vector<index_t> small;
+            std::vector<index_t> large;
+            for (index_t v = 0; v != csr.vertex_count(); ++v)
+            {
+                auto edges = csr.edge_indices(v);
+                w.resize(edges.size());
+                for (std::size_t j = 0; j != edges.size(); ++j)
+                {
+                    w[j] = static_cast<double>(weight(graph.value(detail::id_access::make_edge_id(edges[j]))));
+                    weights[csr.offset(v) + j] = static_cast<float>(w[j]);
+                }
+                build_alias(csr.offset(v), w, small, large);
+            }
+        }
+
+        //node2vec的返回参数p与进出参数q;p = q = 1时与一阶游走相同
+        void set_node2vec(double p, double q)
+        {
+            assert(p > 0 && q > 0);
+            return_bias = 1 / p;
+            out_bias = 1 / q;
+            max_bias = std::max({return_bias, 1.0, out_bias});
+        }
+        bool weighted() const noexcept
+        {
+            return !probability.empty();
+        }
+
+        //从start出发的一次游走写入out[0, length),out[0]为start
+        template<class RandomT>
+        void walk(index_t start, std::size_t length, RandomT& random, index_t* out) const
+        {
+            if (length == 0)
+                return;
+            out[0] = start;
+            index_t previous = npos;
+            index_t current = start;
+            std::size_t i = 1;
+            for (; i != length; ++i)
+            {
+                index_t next = step(previous, current, random);
+                if (next == npos)
+                    break;
+                out[i] = next;
+                previous = current;
+                current = next;
+            }
+            for (; i != length; ++i)
+                out[i] = npos;
+        }
+
+        //每个起点产生一次游走(需要多次时把起点重复多次),结果按starts的顺序排列
+        walk_buffer run(std::vector<index_t> const& starts, std::size_t length, std::uint64_t seed = 0,
+                        std::size_t threads = 0) const
+        {
+            walk_buffer ret(starts.size(), length);
+            index_t* out = ret.data();
+            for_each_chunk(starts, seed, threads, [&](std::size_t first, std::size_t count, std::mt19937_64& random, std::vector<index_t>&)
+            {
+                for (std::size_t i = first; i != first + count; ++i)
+                    walk(starts[i], length, random, out + i * length);
+            });
+            return ret;
+        }
+        /*
+         * 不保存全部结果:每个线程把一块(chunk_size次)游走写入自己的缓冲区,再调用sink(first, count, data),
+         * data中第k段为starts[first + k]的游走.sink的调用互斥,但各块的先后顺序不确定.
+         */
+        template<class SinkF>
+        void stream(std::vector<index_t> const& starts, std::size_t length, SinkF sink, std::uint64_t seed = 0,
+                 std::size_t threads = 0) const
+        {
+            std::mutex m;
+            for_each_chunk(starts, seed, threads, [&](std::size_t first, std::size_t count, std::mt19937_64& random, std::vector<index_t>& buffer)
+            {
+                buffer.resize(count * length);
+                for (std::size_t i = 0; i != count; ++i)
+                    walk(starts[first + i], length, random, buffer.data() + i * length);
+                std::lock_guard<std::mutex> lock(m);
+                sink(first, count, static_cast<index_t const*>(buffer.data()));
+            });
+        }
+        //每行一次游走,以空格分隔各顶点在原图中的index
+        void write(std::ostream& out, std::vector<index_t> const& starts, std::size_t length, std::uint64_t seed = 0,
+                   std::size_t threads = 0) const
+        {
+            stream(starts, length, [&](std::size_t, std::size_t count, index_t const* data)
+            {
+                for (std::size_t k = 0; k != count; ++k)
+                {
+                    for (std::size_t i = 0; i != length && data[k * length + i] != npos; ++i)
+                    {
+                        if (i != 0)
+                            out << ' ';
+                        out << detail::id_access::to_stock_id(g->vertex(data[k * length + i])).id();
+                    }
+                    out << '\n';
+                }
+            }, seed, threads);
+        }
+
+        std::size_t memory_usage() const noexcept
+        {
+            return (probability.capacity() + weights.capacity()) * sizeof(float) + alias.capacity() * sizeof(index_t);
+        }
+
+        static constexpr std::size_t chunk_size = 1024;
+
+    private:
+        static constexpr int max_rejections = 16;
+
+        void build_alias(std::size_t offset, std::vector<double> const& w, std::vector<index_t>& small, std::vector<index_t>& large)
+        {
+            std::size_t const d = w.size();
+            double sum = 0;
+            for (double x : w)
+                sum += x;
+            small.clear();
+            large.clear();
+            std::vector<double> scaled(d);
+            for (std::size_t j = 0; j != d; ++j)
+            {
+                scaled[j] = sum > 0 ? w[j] * static_cast<double>(d) / sum : 1;
+                (scaled[j] < 1 ? small : large).push_back(static_cast<index_t>(j));
+            }
+            while (!small.empty() && !large.empty())
+            {
+                index_t s = small.back();
+                small.pop_back();
+                index_t l = large.back();
+                probability[offset + s] = static_cast<float>(scaled[s]);
+                alias[offset + s] = l;
+                scaled[l] -= 1 - scaled[s];
+                if (scaled[l] < 1)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+            for (index_t j : large)         //余下的项概率为1(含舍入误差)
+            {
+                probability[offset + j] = 1;
+                alias[offset + j] = j;
+            }
+            for (index_t j : small)
+            {
+                probability[offset + j] = 1;
+                alias[offset + j] = j;
+            }
+        }
+
+        template<class RandomT>
+        index_t first_order(index_t v, RandomT& random) const   //没有出边时为npos
+        {
+            std::size_t const d = g->degree(v);
+            if (d == 0)
+                return npos;
+            std::size_t j = std::uniform_int_distribution<std::size_t>(0, d - 1)(random);
+            if (weighted() && std::uniform_real_distribution<float>(0, 1)(random) >= probability[g->offset(v) + j])
+                j = alias[g->offset(v) + j];
+            return g->neighbors(v)[j];
+        }
+        double bias(index_t previous, index_t x) const
+        {
+            if (x == previous)
+                return return_bias;
+            auto neighbors = g->neighbors(previous);
+            return std::binary_search(neighbors.begin(), neighbors.end(), x) ? 1 : out_bias;
+        }
+        template<class RandomT>
+        index_t step(index_t previous, index_t current, RandomT& random) const
+        {
+            if (previous == npos || (return_bias == 1 && out_bias == 1))
+                return first_order(current, random);
+            for (int attempt = 0; attempt != max_rejections; ++attempt)     //拒绝采样
+            {
+                index_t x = first_order(current, random);
+                if (x == npos)
+                    return npos;
+                if (std::uniform_real_distribution<double>(0, max_bias)(random) < bias(previous, x))
+                    return x;
+            }
+            //接受率很低(如p, q很大而只能返回)时,改为按精确的二阶权重扫描两遍,分布不变
+            auto neighbors = g->neighbors(current);
+            std::size_t const offset = g->offset(current);
+            double total = 0;
+            for (std::size_t j = 0; j != neighbors.size(); ++j)
+                total += weight(offset + j) * bias(previous, neighbors[j]);
+            double r = std::uniform_real_distribution<double>(0, total)(random);
+            for (std::size_t j = 0; j != neighbors.size(); ++j)
+            {
+                r -= weight(offset + j) * bias(previous, neighbors[j]);
+                if (r < 0)
+                    return neighbors[j];
+            }
+            return neighbors[neighbors.size() - 1];
+        }
+        double weight(std::size_t entry) const
+        {
+            return weighted() ? weights[entry] : 1;
+        }
+
+        //把starts分块,由threads个线程动态领取;每块的随机数引擎由seed与块的编号决定
+        template<class F>
+        void for_each_chunk(std::vector<index_t> const& starts, std::uint64_t seed, std::size_t threads, F f) const
+        {
+            std::size_t const chunks = (starts.size() + chunk_size - 1) / chunk_size;
+            if (threads == 0)
+                threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            threads = std::max<std::size_t>(1, std::min(threads, chunks));
+            std::atomic<std::size_t> next{0};
+            auto work = [&]
+            {
+                std::vector<index_t> buffer;
+                for (std::size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks;)
+                {
+                    std::seed_seq sequence{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                                           static_cast<std::uint32_t>(c), static_cast<std::uint32_t>(std::uint64_t(c) >> 32)};
+                    std::mt19937_64 random(sequence);
+                    std::size_t const first = c * chunk_size;
+                    f(first, std::min(std::size_t(chunk_size), starts.size() - first), random, buffer);
+                }
+            };
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < threads; ++t)
+                pool.emplace_back(work);
+            work();
+            for (auto& t : pool)
+                t.join();
+        }
+
+        csr_graph const* g;
+        std::vector<float> probability;     //按邻接项;为空时为均匀游走
+        std::vector<float> weights;         //拒绝采样失败时的精确采样使用
+        std::vector<index_t> alias;         //邻接项在所在行中的下标
+        double return_bias = 1;
+        double out_bias = 1;
+        double max_bias = 1;
+    };
+}
+
+#endif //GRAPH_RANDOM_WALK_H
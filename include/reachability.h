@@ -0,0 +1,422 @@
+#ifndef GRAPH_REACHABILITY_H
+#define GRAPH_REACHABILITY_H
+
+#include <algorithm>  //for std::sort, std::unique, std::shuffle, std::min, std::max, std::equal, std::fill
+#include <cstddef>    //for std::size_t
+#include <cstdint>    //for std::uint32_t, std::uint64_t
+#include <istream>    //for std::istream
+#include <limits>     //for std::numeric_limits
+#include <numeric>    //for std::iota
+#include <ostream>    //for std::ostream
+#include <random>     //for std::mt19937_64
+#include <stdexcept>  //for std::runtime_error
+#include <string>     //for std::string
+#include <thread>     //for std::thread
+#include <utility>    //for std::pair
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief 有向图的可达性索引:强连通分量缩点 + GRAIL区间标签.
+ *
+ * 构造时先用Tarjan算法把每个强连通分量缩为一个点,得到一个DAG,分量按完成顺序编号,因此DAG中的边总是从大编号指向小编号.
+ * 然后对DAG做label_count次随机顺序的DFS,每次为每个分量c记录区间[low(c), post(c)],
+ * post为后序编号,low为c能到达的分量中最小的post.c能到达d时d的每个区间都包含在c的区间中.
+ * 各次DFS互不依赖,由多个线程同时进行.
+ *
+ * reachable(x, y)依次用分量编号,拓扑层次与区间排除不可达的情况,大多数否定的查询为O(label_count);
+ * 其余查询在DAG上做DFS,并在每一步用同样的条件剪枝.查询为const,可以在多个线程中同时进行.
+ *
+ * 索引是构造时的快照,不随图的修改而更新,修改后需要重新构造:
+ * Tarjan为O(V + E),标签为O(label_count * (C + E')),C与E'为DAG的顶点数与边数.
+ * add_edge(x, y)时若reachable(x, y)已为true,可达关系不变,索引仍然有效;
+ * remove_edge(x, y)时若x与y原本就不在同一个分量中且DAG中x的分量到y的分量还有其它路径,可达关系也不变,
+ * 但这无法由索引本身判断,一般应重新构造.
+ */
+
+namespace lzhlib
+{
+    namespace exceptions
+    {
+        class bad_reachability_index_stream : public std::runtime_error
+        {
+        public:
+            bad_reachability_index_stream()
+                : std::runtime_error(std::string("bad reachability index stream!"))
+            {
+
+            }
+        };
+    }
+
+    namespace detail
+    {
+        template<class T>
+        void write_pod(std::ostream& out, T const& x)
+        {
+            out.write(reinterpret_cast<char const*>(&x), sizeof(T));
+        }
+        template<class T>
+        void read_pod(std::istream& in, T& x)
+        {
+            if (!in.read(reinterpret_cast<char*>(&x), sizeof(T)))
+                throw exceptions::bad_reachability_index_stream();
+        }
+        template<class T>
+        void write_pod_vector(std::ostream& out, std::vector<T> const& v)
+        {
+            write_pod(out, static_cast<std::uint64_t>(v.size()));
+            out.write(reinterpret_cast<char const*>(v.data()), static_cast<std::streamsize>(v.size() * sizeof(T)));
+        }
+        template<class T>
+        void read_pod_vector(std::istream& in, std::vector<T>& v)
+        {
+            std::uint64_t size;
+            read_pod(in, size);
+            v.clear();
+            for (std::uint64_t read = 0; read != size;)     //按块读取,损坏的长度不会一次分配过多内存
+            {
+                std::size_t const chunk = static_cast<std::size_t>(std::min<std::uint64_t>(size - read, 1 << 16));
+                v.resize(v.size() + chunk);
+                if (!in.read(reinterpret_cast<char*>(v.data() + read), static_cast<std::streamsize>(chunk * sizeof(T))))
+                    throw exceptions::bad_reachability_index_stream();
+                read += chunk;
+            }
+        }
+    }
+
+    class reachability_index
+    {
+    public:
+        using index_t = std::uint32_t;
+        static constexpr index_t npos = static_cast<index_t>(-1);
+
+        reachability_index() = default;
+        template<class GraphT>
+        explicit reachability_index(GraphT const& g, std::size_t label_count = 3, std::size_t threads = 0, std::uint64_t seed = 0)
+            : reachability_index(csr_graph(g), label_count, threads, seed)
+        {}
+        //threads为0时使用std::thread::hardware_concurrency()个线程,最多label_count个
+        reachability_index(csr_graph const& g, std::size_t label_count, std::size_t threads = 0, std::uint64_t seed = 0)
+            : labels(std::max<std::size_t>(1, label_count))
+        {
+            std::vector<index_t> dense_component = condense(g);
+            for (index_t v = 0; v != g.vertex_count(); ++v)
+            {
+                std::size_t const i = detail::id_access::to_stock_id(g.vertex(v)).id();
+                if (i >= component_of.size())
+                    component_of.resize(i + 1, index_t(npos));
+                component_of[i] = dense_component[v];
+            }
+            build_dag(g, dense_component);
+            build_labels(threads, seed);
+        }
+
+        bool contains(vertex_id v) const noexcept     //v是否在构造时存在
+        {
+            std::size_t const i = detail::id_access::to_stock_id(v).id();
+            return i < component_of.size() && component_of[i] != npos;
+        }
+        //precondition: contains(x) && contains(y).每个顶点都可以到达自身
+        bool reachable(vertex_id x, vertex_id y) const
+        {
+            return reaches(component(x), component(y));
+        }
+        bool same_component(vertex_id x, vertex_id y) const
+        {
+            return component(x) == component(y);
+        }
+        index_t component(vertex_id v) const     //强连通分量的编号,v能到达的分量的编号都不大于它
+        {
+            return component_of[detail::id_access::to_stock_id(v).id()];
+        }
+        std::size_t component_count() const noexcept
+        {
+            return level.size();
+        }
+        std::size_t label_count() const noexcept
+        {
+            return labels;
+        }
+        std::size_t memory_usage() const noexcept
+        {
+            return component_of.capacity() * sizeof(index_t) + offsets.capacity() * sizeof(std::size_t) +
+                   targets.capacity() * sizeof(index_t) + level.capacity() * sizeof(index_t) +
+                   intervals.capacity() * sizeof(interval);
+        }
+
+        /*
+         * 二进制格式,按本机字节序与类型宽度写出,只保证在同一平台上读回.
+         * load在流中的数据不完整或不一致时抛出exceptions::bad_reachability_index_stream.
+         */
+        void save(std::ostream& out) const
+        {
+            out.write(magic(), magic_size);
+            detail::write_pod(out, static_cast<std::uint64_t>(labels));
+            detail::write_pod_vector(out, component_of);
+            detail::write_pod_vector(out, offsets);
+            detail::write_pod_vector(out, targets);
+            detail::write_pod_vector(out, level);
+            detail::write_pod_vector(out, intervals);
+        }
+        static reachability_index load(std::istream& in)
+        {
+            char header[magic_size];
+            if (!in.read(header, magic_size) || !std::equal(header, header + magic_size, magic()))
+                throw exceptions::bad_reachability_index_stream();
+            reachability_index ret;
+            std::uint64_t stored_labels;
+            detail::read_pod(in, stored_labels);
+            if (stored_labels > std::numeric_limits<std::size_t>::max())
+                throw exceptions::bad_reachability_index_stream();
+            ret.labels = static_cast<std::size_t>(stored_labels);
+            detail::read_pod_vector(in, ret.component_of);
+            detail::read_pod_vector(in, ret.offsets);
+            detail::read_pod_vector(in, ret.targets);
+            detail::read_pod_vector(in, ret.level);
+            detail::read_pod_vector(in, ret.intervals);
+            if (!ret.consistent())
+                throw exceptions::bad_reachability_index_stream();
+            return ret;
+        }
+
+    private:
+        struct interval
+        {
+            index_t low;
+            index_t post;
+        };
+        static char const* magic() noexcept
+        {
+            return "LZHREAC1";
+        }
+        static constexpr std::size_t magic_size = 8;
+
+        std::vector<index_t> condense(csr_graph const& g)   //Tarjan,返回每个稠密编号所在的分量
+        {
+            std::size_t const n = g.vertex_count();
+            std::vector<index_t> component(n, index_t(npos));
+            std::vector<index_t> discovered(n, index_t(npos));
+            std::vector<index_t> low(n);
+            std::vector<index_t> stack;
+            std::vector<std::pair<index_t, std::size_t>> frames;    //顶点与下一个要检查的邻接项
+            index_t time = 0;
+            index_t count = 0;
+            for (index_t root = 0; root != n; ++root)
+            {
+                if (discovered[root] != npos)
+                    continue;
+                frames.emplace_back(root, 0);
+                discovered[root] = low[root] = time++;
+                stack.push_back(root);
+                while (!frames.empty())
+                {
+                    index_t const v = frames.back().first;
+                    auto neighbors = g.neighbors(v);
+                    if (frames.back().second != neighbors.size())
+                    {
+                        index_t const u = neighbors[frames.back().second++];
+                        if (discovered[u] == npos)
+                        {
+                            discovered[u] = low[u] = time++;
+                            stack.push_back(u);
+                            frames.emplace_back(u, 0);
+                        }
+                        else if (component[u] == npos)      //仍在栈中
+                            low[v] = std::min(low[v], discovered[u]);
+                        continue;
+                    }
+                    frames.pop_back();
+                    if (!frames.empty())
+                        low[frames.back().first] = std::min(low[frames.back().first], low[v]);
+                    if (low[v] == discovered[v])
+                    {
+                        index_t u;
+                        do
+                        {
+                            u = stack.back();
+                            stack.pop_back();
+                            component[u] = count;
+                        } while (u != v);
+                        ++count;
+                    }
+                }
+            }
+            level.assign(count, 0);
+            return component;
+        }
+        void build_dag(csr_graph const& g, std::vector<index_t> const& component)
+        {
+            std::size_t const c = level.size();
+            std::vector<index_t> members(g.vertex_count());     //按分量排列的稠密编号
+            std::vector<std::size_t> first(c + 1, 0);
+            for (index_t v : component)
+                ++first[v + 1];
+            for (std::size_t i = 0; i != c; ++i)
+                first[i + 1] += first[i];
+            {
+                std::vector<std::size_t> next(first.begin(), first.end() - 1);
+                for (index_t v = 0; v != component.size(); ++v)
+                    members[next[component[v]]++] = v;
+            }
+            offsets.assign(1, 0);
+            offsets.reserve(c + 1);
+            std::vector<index_t> row;
+            for (index_t x = 0; x != c; ++x)
+            {
+                row.clear();
+                for (std::size_t m = first[x]; m != first[x + 1]; ++m)
+                    for (index_t u : g.neighbors(members[m]))
+                        if (component[u] != x)
+                            row.push_back(component[u]);
+                std::sort(row.begin(), row.end());
+                row.erase(std::unique(row.begin(), row.end()), row.end());
+                for (index_t y : row)       //y < x,其层次已经确定
+                {
+                    targets.push_back(y);
+                    level[x] = std::max(level[x], level[y] + 1);
+                }
+                offsets.push_back(targets.size());
+            }
+        }
+        void build_labels(std::size_t threads, std::uint64_t seed)
+        {
+            std::size_t const c = level.size();
+            intervals.resize(c * labels);
+            if (threads == 0)
+                threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+            threads = std::min(threads, labels);
+            auto work = [&](std::size_t t)
+            {
+                for (std::size_t i = t; i < labels; i += threads)
+                    label(i, seed + i);
+            };
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < threads; ++t)
+                pool.emplace_back(work, t);
+            work(0);
+            for (auto& t : pool)
+                t.join();
+        }
+        void label(std::size_t which, std::uint64_t seed)     //一次随机顺序的DFS,只写intervals中第which列
+        {
+            std::size_t const c = level.size();
+            std::mt19937_64 random(seed);
+            std::vector<index_t> order(c);
+            std::iota(order.begin(), order.end(), index_t(0));
+            std::shuffle(order.begin(), order.end(), random);
+            std::vector<index_t> children(targets);         //每行内打乱的邻接表
+            for (std::size_t x = 0; x != c; ++x)
+                std::shuffle(children.begin() + offsets[x], children.begin() + offsets[x + 1], random);
+
+            std::vector<bool> visited(c, false);
+            std::vector<std::pair<index_t, std::size_t>> frames;
+            index_t post = 0;
+            for (index_t root : order)
+            {
+                if (visited[root])
+                    continue;
+                visited[root] = true;
+                frames.emplace_back(root, offsets[root]);
+                while (!frames.empty())
+                {
+                    index_t const x = frames.back().first;
+                    if (frames.back().second != offsets[x + 1])
+                    {
+                        index_t const y = children[frames.back().second++];
+                        if (!visited[y])
+                        {
+                            visited[y] = true;
+                            frames.emplace_back(y, offsets[y]);
+                        }
+                        continue;
+                    }
+                    frames.pop_back();
+                    interval& l = intervals[x * labels + which];
+                    l.post = post++;
+                    l.low = l.post;
+                    for (std::size_t k = offsets[x]; k != offsets[x + 1]; ++k)
+                        l.low = std::min(l.low, intervals[targets[k] * labels + which].low);
+                }
+            }
+        }
+
+        bool may_reach(index_t x, index_t y) const noexcept      //为false时x一定不能到达y
+        {
+            if (x < y || level[x] <= level[y])
+                return false;
+            interval const* a = &intervals[x * labels];
+            interval const* b = &intervals[y * labels];
+            for (std::size_t i = 0; i != labels; ++i)
+                if (b[i].low < a[i].low || a[i].post < b[i].post)
+                    return false;
+            return true;
+        }
+        bool reaches(index_t x, index_t y) const
+        {
+            if (x == y)
+                return true;
+            if (!may_reach(x, y))
+                return false;
+            //在DAG上剪枝的DFS.标记数组按线程保存,以代数区分各次查询,不必每次清零
+            static thread_local std::vector<std::uint32_t> marks;
+            static thread_local std::uint32_t generation = 0;
+            if (marks.size() < level.size())
+                marks.resize(level.size(), 0);
+            if (++generation == 0)
+            {
+                std::fill(marks.begin(), marks.end(), 0);
+                generation = 1;
+            }
+            static thread_local std::vector<index_t> stack;
+            stack.assign(1, x);
+            marks[x] = generation;
+            while (!stack.empty())
+            {
+                index_t const z = stack.back();
+                stack.pop_back();
+                for (std::size_t k = offsets[z]; k != offsets[z + 1]; ++k)
+                {
+                    index_t const w = targets[k];
+                    if (w == y)
+                        return true;
+                    if (marks[w] != generation && may_reach(w, y))
+                    {
+                        marks[w] = generation;
+                        stack.push_back(w);
+                    }
+                }
+            }
+            return false;
+        }
+        bool consistent() const noexcept
+        {
+            std::size_t const c = level.size();
+            //用除法比较区间数,避免c * labels溢出后恰好相等
+            if (labels == 0 || offsets.size() != c + 1 || offsets.front() != 0 || offsets.back() != targets.size() ||
+                intervals.size() / labels != c || intervals.size() % labels != 0)
+                return false;
+            for (std::size_t x = 0; x != c; ++x)
+                if (offsets[x] > offsets[x + 1])
+                    return false;
+            for (std::size_t x = 0; x != c; ++x)
+                for (std::size_t k = offsets[x]; k != offsets[x + 1]; ++k)
+                    if (targets[k] >= x)
+                        return false;
+            for (index_t v : component_of)
+                if (v != npos && v >= c)
+                    return false;
+            return true;
+        }
+
+        std::size_t labels = 1;
+        std::vector<index_t> component_of;      //按顶点index
+        std::vector<std::size_t> offsets;       //DAG的邻接表
+        std::vector<index_t> targets;
+        std::vector<index_t> level;             //到汇点的最长路径的边数
+        std::vector<interval> intervals;        //第x个分量的label_count个区间相邻存放
+    };
+}
+
+#endif //GRAPH_REACHABILITY_H
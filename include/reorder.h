@@ -0,0 +1,317 @@
+#ifndef GRAPH_REORDER_H
+#define GRAPH_REORDER_H
+
+#include <algorithm>  //for std::stable_sort, std::reverse, std::max_element
+#include <cmath>      //for std::sqrt
+#include <cstddef>    //for std::size_t
+#include <queue>      //for std::priority_queue
+#include <utility>    //for std::pair, std::move
+#include <vector>     //for std::vector
+#include "Graph/include/csr_graph.h"
+#include "Graph/include/id_remap.h"
+
+/** \file
+ *  \brief 改善访存局部性的顶点重排.
+ *
+ * 顶点的id来自插入顺序,相邻的顶点在存储中往往相距很远.下面的函数根据csr_graph计算一个排列
+ * (new_index[旧稠密编号] = 新稠密编号),再由csr_graph::permuted或apply_order作用到快照或图上:
+ *  - reverse_cuthill_mckee: 减小带宽,适合网格,道路等度数较均匀的图
+ *  - degree_descending:     按度数降序,高度数顶点集中在前部
+ *  - hub_clustering:        只把高度数顶点移到前部,其余顶点保持原有的相对顺序
+ *  - gorder:                贪心地让窗口内的顶点共享尽量多的邻居,对幂律图通常效果最好,但代价也最高
+ * 有向图按无向处理(出边与入边都视为相邻).
+ */
+
+namespace lzhlib
+{
+    using vertex_order = std::vector<csr_graph::index_t>;
+
+    namespace detail
+    {
+        //出邻居与入邻居;无向图的csr_graph本身已对称,不必再建转置
+        class symmetric_neighbors
+        {
+        public:
+            using index_t = csr_graph::index_t;
+
+            explicit symmetric_neighbors(csr_graph const& g)
+                : g(g)
+            {
+                if (!g.is_directed())
+                    return;
+                std::size_t const n = g.vertex_count();
+                in_offsets.assign(n + 1, 0);
+                for (index_t v = 0; v != n; ++v)
+                    for (index_t u : g.neighbors(v))
+                        ++in_offsets[u + 1];
+                for (std::size_t v = 0; v != n; ++v)
+                    in_offsets[v + 1] += in_offsets[v];
+                in_sources.resize(g.entry_count());
+                std::vector<std::size_t> fill(in_offsets.begin(), in_offsets.end() - 1);
+                for (index_t v = 0; v != n; ++v)
+                    for (index_t u : g.neighbors(v))
+                        in_sources[fill[u]++] = v;
+            }
+
+            std::size_t degree(index_t v) const
+            {
+                return g.degree(v) + (g.is_directed() ? in_offsets[v + 1] - in_offsets[v] : 0);
+            }
+            template<class F>
+            void for_each(index_t v, F f) const      //所有相邻顶点,有向图中双向边上的顶点会出现两次
+            {
+                for (index_t u : g.neighbors(v))
+                    f(u);
+                if (g.is_directed())
+                    for (std::size_t k = in_offsets[v]; k != in_offsets[v + 1]; ++k)
+                        f(in_sources[k]);
+            }
+            template<class F>
+            void for_each_in(index_t v, F f) const   //指向v的顶点
+            {
+                if (!g.is_directed())
+                    for (index_t u : g.neighbors(v))
+                        f(u);
+                else
+                    for (std::size_t k = in_offsets[v]; k != in_offsets[v + 1]; ++k)
+                        f(in_sources[k]);
+            }
+
+        private:
+            csr_graph const& g;
+            std::vector<std::size_t> in_offsets;
+            std::vector<index_t> in_sources;
+        };
+
+        inline vertex_order order_to_permutation(std::vector<csr_graph::index_t> const& order)  //order[新] = 旧
+        {
+            vertex_order ret(order.size());
+            for (std::size_t i = 0; i != order.size(); ++i)
+                ret[order[i]] = static_cast<csr_graph::index_t>(i);
+            return ret;
+        }
+    }
+
+    inline vertex_order reverse_cuthill_mckee(csr_graph const& g)
+    {
+        using index_t = csr_graph::index_t;
+        std::size_t const n = g.vertex_count();
+        detail::symmetric_neighbors adj(g);
+        std::vector<index_t> by_degree(n);
+        for (index_t v = 0; v != n; ++v)
+            by_degree[v] = v;
+        std::stable_sort(by_degree.begin(), by_degree.end(), [&](index_t a, index_t b)
+        {
+            return adj.degree(a) < adj.degree(b);
+        });
+
+        std::vector<index_t> order;
+        order.reserve(n);
+        std::vector<bool> placed(n, false);
+        std::vector<std::size_t> level(n);
+        std::vector<std::size_t> stamp(n, 0);        //stamp[v] == round 表示v在本轮BFS中已访问
+        std::size_t round = 0;
+        std::vector<index_t> frontier;
+        std::vector<index_t> next;
+        std::vector<index_t> children;
+
+        auto eccentricity = [&](index_t root, index_t& farthest)  //BFS求root的偏心距,farthest为最后一层中度数最小的顶点
+        {
+            ++round;
+            stamp[root] = round;
+            frontier.assign(1, root);
+            std::size_t depth = 0;
+            for (;;)
+            {
+                next.clear();
+                for (index_t v : frontier)
+                    adj.for_each(v, [&](index_t u)
+                    {
+                        if (stamp[u] != round)
+                        {
+                            stamp[u] = round;
+                            next.push_back(u);
+                        }
+                    });
+                if (next.empty())
+                    break;
+                frontier.swap(next);
+                ++depth;
+            }
+            farthest = *std::min_element(frontier.begin(), frontier.end(), [&](index_t a, index_t b)
+            {
+                return adj.degree(a) < adj.degree(b);
+            });
+            return depth;
+        };
+
+        for (index_t seed : by_degree)
+        {
+            if (placed[seed])
+                continue;
+            //George-Liu: 在分量内寻找伪外围顶点作为起点
+            index_t root = seed;
+            index_t candidate;
+            std::size_t depth = eccentricity(root, candidate);
+            for (int i = 0; i != 8; ++i)
+            {
+                index_t further;
+                std::size_t d = eccentricity(candidate, further);
+                if (d <= depth)
+                    break;
+                root = candidate;
+                depth = d;
+                candidate = further;
+            }
+
+            std::size_t head = order.size();
+            order.push_back(root);
+            placed[root] = true;
+            while (head != order.size())
+            {
+                index_t v = order[head++];
+                children.clear();
+                adj.for_each(v, [&](index_t u)
+                {
+                    if (!placed[u])
+                    {
+                        placed[u] = true;
+                        children.push_back(u);
+                    }
+                });
+                std::stable_sort(children.begin(), children.end(), [&](index_t a, index_t b)
+                {
+                    return adj.degree(a) < adj.degree(b);
+                });
+                order.insert(order.end(), children.begin(), children.end());
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return detail::order_to_permutation(order);
+    }
+
+    inline vertex_order degree_descending(csr_graph const& g)
+    {
+        using index_t = csr_graph::index_t;
+        detail::symmetric_neighbors adj(g);
+        std::vector<index_t> order(g.vertex_count());
+        for (index_t v = 0; v != order.size(); ++v)
+            order[v] = v;
+        std::stable_sort(order.begin(), order.end(), [&](index_t a, index_t b)
+        {
+            return adj.degree(a) > adj.degree(b);
+        });
+        return detail::order_to_permutation(order);
+    }
+
+    //度数大于平均度数 * factor的顶点为hub.hub集中在前部,hub之间及其余顶点之间都保持原有的相对顺序
+    inline vertex_order hub_clustering(csr_graph const& g, double factor = 1.0)
+    {
+        using index_t = csr_graph::index_t;
+        std::size_t const n = g.vertex_count();
+        detail::symmetric_neighbors adj(g);
+        std::size_t total = 0;
+        for (index_t v = 0; v != n; ++v)
+            total += adj.degree(v);
+        double const threshold = n == 0 ? 0 : factor * static_cast<double>(total) / static_cast<double>(n);
+        std::vector<index_t> order;
+        order.reserve(n);
+        for (index_t v = 0; v != n; ++v)
+            if (adj.degree(v) > threshold)
+                order.push_back(v);
+        for (index_t v = 0; v != n; ++v)
+            if (!(adj.degree(v) > threshold))
+                order.push_back(v);
+        return detail::order_to_permutation(order);
+    }
+
+    /*
+     * Gorder(Wei et al., SIGMOD 2016)的贪心算法:依次放置与最近window个已放置顶点得分最高的顶点,
+     * 得分为 相邻次数 + 共同入邻居数.度数超过hub_limit(默认sqrt(V))的顶点不参与共同邻居的计数,
+     * 以免一个hub使代价变为平方级.使用惰性删除的堆,每次得分变化压入一个新条目.
+     */
+    inline vertex_order gorder(csr_graph const& g, std::size_t window = 5, std::size_t hub_limit = 0)
+    {
+        using index_t = csr_graph::index_t;
+        std::size_t const n = g.vertex_count();
+        if (n == 0)
+            return {};
+        if (hub_limit == 0)
+            hub_limit = static_cast<std::size_t>(std::sqrt(static_cast<double>(n))) + 1;
+        detail::symmetric_neighbors adj(g);
+
+        std::vector<std::size_t> score(n, 0);
+        std::vector<bool> placed(n, false);
+        using entry = std::pair<std::size_t, index_t>;
+        auto worse = [](entry const& a, entry const& b)     //得分高者优先,同分时编号小者优先
+        {
+            return a.first != b.first ? a.first < b.first : a.second > b.second;
+        };
+        std::priority_queue<entry, std::vector<entry>, decltype(worse)> heap(worse);
+        for (index_t v = 0; v != n; ++v)
+            heap.emplace(0, v);
+
+        auto update = [&](index_t v, bool entering)
+        {
+            auto touch = [&](index_t u)
+            {
+                if (placed[u])
+                    return;
+                if (entering)
+                    ++score[u];
+                else
+                    --score[u];
+                heap.emplace(score[u], u);
+            };
+            adj.for_each(v, touch);
+            adj.for_each_in(v, [&](index_t w)
+            {
+                if (g.degree(w) <= hub_limit)
+                    for (index_t u : g.neighbors(w))
+                        if (u != v)
+                            touch(u);
+            });
+        };
+
+        std::vector<index_t> order;
+        order.reserve(n);
+        index_t first = 0;
+        for (index_t v = 1; v != n; ++v)
+            if (adj.degree(v) > adj.degree(first))
+                first = v;
+        for (index_t v = first;;)
+        {
+            placed[v] = true;
+            order.push_back(v);
+            if (order.size() == n)
+                break;
+            update(v, true);
+            if (order.size() > window)
+                update(order[order.size() - 1 - window], false);
+            for (;;)
+            {
+                entry top = heap.top();
+                heap.pop();
+                if (!placed[top.second] && score[top.second] == top.first)
+                {
+                    v = top.second;
+                    break;
+                }
+            }
+        }
+        return detail::order_to_permutation(order);
+    }
+
+    //把由g构造的csr上计算出的排列作用到g上(构造csr之后g不应被修改过).返回旧id到新id的映射
+    template<class GraphT>
+    id_remap apply_order(GraphT& g, csr_graph const& csr, vertex_order const& new_index)
+    {
+        std::size_t const npos = id_remap::npos;
+        std::vector<std::size_t> vertex_map(g.vertex_index_bound(), npos);
+        for (csr_graph::index_t v = 0; v != csr.vertex_count(); ++v)
+            vertex_map[g.index(csr.vertex(v))] = new_index[v];
+        return g.reorder(std::move(vertex_map));
+    }
+}
+
+#endif //GRAPH_REORDER_H
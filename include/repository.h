@@ -3,19 +3,73 @@
 
 #include <stdexcept>  //for std::out_of_range
 #include <vector>     //for std::vector
-#include <memory>     //for std::unique_ptr
+#include <memory>     //for std::unique_ptr, std::allocator, std::allocator_traits
 #include <set>        //for std::set
+#include <type_traits>//for std::is_empty, std::is_final
 #include "Graph/include/stock_id.h"
+#include "Graph/include/instrumentation.h"
 
 namespace lzhlib
 {
-    template<class StockT>
+    namespace detail
+    {
+        //空的分配器(如std::allocator)作为基类保存,不占用空间,使repository::pointer_t与裸指针一样大
+        template<class AllocatorT, bool = std::is_empty<AllocatorT>::value && !std::is_final<AllocatorT>::value>
+        class allocator_holder : private AllocatorT
+        {
+        public:
+            allocator_holder() = default;
+            explicit allocator_holder(AllocatorT const& a)
+                : AllocatorT(a)
+            {}
+            AllocatorT& allocator() noexcept
+            {
+                return *this;
+            }
+        };
+        template<class AllocatorT>
+        class allocator_holder<AllocatorT, false>
+        {
+        public:
+            allocator_holder() = default;
+            explicit allocator_holder(AllocatorT const& a)
+                : alloc(a)
+            {}
+            AllocatorT& allocator() noexcept
+            {
+                return alloc;
+            }
+
+        private:
+            AllocatorT alloc;
+        };
+    }
+
+    template<class StockT, class AllocatorT = std::allocator<StockT>>
     class repository
     {
     public:
         using stock_t = StockT;
         using id_t = stock_id;
-        using pointer_t = std::unique_ptr<stock_t>;
+        using allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<stock_t>;
+
+        class stock_deleter    //gives every stock back to the allocator it came from
+            : private detail::allocator_holder<allocator_t>
+        {
+        public:
+            stock_deleter() = default;
+            explicit stock_deleter(allocator_t const& a)
+                : detail::allocator_holder<allocator_t>(a)
+            {}
+            void operator()(stock_t* p)
+            {
+                allocator_t& alloc = this->allocator();
+                std::allocator_traits<allocator_t>::destroy(alloc, p);
+                std::allocator_traits<allocator_t>::deallocate(alloc, p, 1);
+            }
+        };
+
+        using pointer_t = std::unique_ptr<stock_t, stock_deleter>;
 
         class attempt_to_use_unassigned_stock : public std::out_of_range
         {
@@ -49,8 +103,18 @@ namespace lzhlib
             }
         };
 
+        explicit repository(allocator_t const& a = allocator_t())
+            : stocks(slot_allocator_t(a)), alloc(a)
+        {}
+
+        allocator_t get_allocator() const
+        {
+            return alloc;
+        }
+
         stock_t& get_stock(id_t id)
         {
+            LZHLIB_GRAPH_COUNT(stock_lookups, 1);
 #ifndef NDEBUG
             if (is_not_valid(id))
             {
@@ -61,6 +125,7 @@ namespace lzhlib
         }
         stock_t const& get_stock(id_t id) const
         {
+            LZHLIB_GRAPH_COUNT(stock_lookups, 1);
 #ifndef NDEBUG
             if (is_not_valid(id))
             {
@@ -75,12 +140,15 @@ namespace lzhlib
             id_t ret = reusable_stock();
             if (ret == stocks.size())  //no reusable stock
             {
-                return allocate_stock(std::forward<Args>(args)...);
+                ret = allocate_stock(std::forward<Args>(args)...);
             }
             else
             {
-                return reuse_stock(ret,std::forward<Args>(args)...);
+                ret = reuse_stock(ret,std::forward<Args>(args)...);
             }
+            first_free = ret;
+            ++first_free;
+            return ret;
         }
         void remove_stock(id_t id)
         {
@@ -88,7 +156,11 @@ namespace lzhlib
             if (is_not_valid(id))
                 throw attempt_to_remove_nonexistent_stock(id);
 #endif // NDEBUG
+            LZHLIB_GRAPH_COUNT(stock_removals, 1);
             stocks[id.id()].reset();
+            --live;
+            if (id < first_free)
+                first_free = id;
         }
         id_t first_stock() const
         {
@@ -103,11 +175,46 @@ namespace lzhlib
             return stock_at_or_after(++current);   //postcondition: 设返回值为next,则stocks[next.id()]为current代表的位置或current代表的位置之后的位置上的有效stock的左值,
         }                                          // 或者next.id() == stocks.size()(current代表的位置之后的位置上均无有效stock
 
+        std::size_t size() const noexcept          //number of valid stocks
+        {
+            return live;
+        }
+        std::size_t slot_count() const noexcept    //number of slots, valid or not.Every valid id is less than this.
+        {
+            return stocks.size();
+        }
+        std::size_t slot_capacity() const noexcept
+        {
+            return stocks.capacity();
+        }
+        void reserve(std::size_t slots)
+        {
+            stocks.reserve(slots);
+        }
+        //把有效的stock i移到new_index[i]处,之后共有new_size个slot,多余的容量被释放.
+        //precondition: new_index把所有有效stock映射到[0,new_size)中互不相同的位置;无效stock对应的值被忽略
+        void renumber(std::vector<std::size_t> const& new_index, std::size_t new_size)
+        {
+            std::vector<pointer_t, slot_allocator_t> renumbered(stocks.get_allocator());
+            renumbered.reserve(new_size);
+            for (std::size_t i = 0; i != new_size; ++i)
+                renumbered.emplace_back(nullptr, stock_deleter(alloc));
+            for (std::size_t i = 0; i != stocks.size(); ++i)
+                if (stocks[i] != nullptr)
+                    renumbered[new_index[i]] = std::move(stocks[i]);
+            stocks.swap(renumbered);
+            first_free = id_t{0};
+        }
+        std::size_t memory_usage() const noexcept   //bytes held by the slots and the stocks they point to
+        {
+            return stocks.capacity() * sizeof(pointer_t) + live * sizeof(stock_t);
+        }
+
     private:
 #ifndef NDEBUG
         bool is_not_valid(id_t id) const
         {
-            return stocks[id.id()] == nullptr;
+            return id.id() >= stocks.size() || stocks[id.id()] == nullptr;
         }
 #endif // NDEBUG
         bool no_reusable_stocks()
@@ -117,24 +224,48 @@ namespace lzhlib
         template<class ...Args>
         id_t allocate_stock(Args&& ... args)
         {
-            stocks.push_back(std::make_unique<stock_t>(std::forward<Args>(args)...));
+            LZHLIB_GRAPH_TIME(stock_allocation);
+            LZHLIB_GRAPH_COUNT(stock_allocations, 1);
+            stocks.push_back(make_stock(std::forward<Args>(args)...));
             id_t ret{stocks.size() -
                      1};    //the allocated stock is at the last position in the container.
+            ++live;
             return ret;
         }
         template<class ...Args>
         id_t reuse_stock(id_t reused, Args&& ... args)//precondition:stocks[reused.id()]必须为一个空指针
         {
-            reusable_pointer(reused) = std::make_unique<stock_t>(std::forward<Args>(args)...);
+            LZHLIB_GRAPH_TIME(stock_reuse);
+            LZHLIB_GRAPH_COUNT(stock_reuses, 1);
+            reusable_pointer(reused) = make_stock(std::forward<Args>(args)...);
+            ++live;
             return reused;
         }
         id_t reusable_stock() const               //postcondition: 设返回值为ret,则stocks[ret.id()]为一个空指针.
         {                                         //或者ret.id() == stocks.size()(current代表的位置及current代表的位置之后的位置上均无reusable stock
-            id_t current{0};
+            LZHLIB_GRAPH_TIME(reuse_probe);
+            id_t current = first_free;              //first_free之前的slot均不可复用
             while (current.id() != stocks.size() && stocks[current.id()] != nullptr)
                 ++current;
+            LZHLIB_GRAPH_COUNT(reuse_probe_length, current.id() - first_free.id());
             return current;
         }
+        template<class ...Args>
+        pointer_t make_stock(Args&& ... args)
+        {
+            using traits = std::allocator_traits<allocator_t>;
+            stock_t* p = traits::allocate(alloc, 1);
+            try
+            {
+                traits::construct(alloc, p, std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                traits::deallocate(alloc, p, 1);
+                throw;
+            }
+            return pointer_t(p, stock_deleter(alloc));
+        }
         pointer_t& reusable_pointer(id_t id)          //just a checker.The calling may be optimized out -- that's to say, may be inlined.
         {
 #ifndef NDEBUG
@@ -145,12 +276,21 @@ namespace lzhlib
         }
         id_t stock_at_or_after(id_t current) const //precondition: current.id() <= stocks.size()
         {
+#ifdef LZHLIB_GRAPH_INSTRUMENTATION
+            id_t const start = current;
+#endif // LZHLIB_GRAPH_INSTRUMENTATION
             while (current.id() != stocks.size() && stocks[current.id()] == nullptr)
                 ++current;
+            LZHLIB_GRAPH_COUNT(iteration_skips, current.id() - start.id());
             return current;                       //postcondition: 设返回值为next,则stocks[next.id()]为指向current代表的位置或current代表的位置之后的位置上的有效stock的指针的左值,
         }                                         //或者next.id() == stocks.size()(current代表的位置及current代表的位置之后的位置上均无有效stock
     private:
-        std::vector<pointer_t> stocks;
+        using slot_allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<pointer_t>;
+
+        std::vector<pointer_t, slot_allocator_t> stocks;
+        allocator_t alloc;
+        std::size_t live = 0;
+        id_t first_free{0};        //lowest slot that may be reusable; every slot before it holds a stock
     };
 
 }
@@ -0,0 +1,312 @@
+#ifndef GRAPH_SUBGRAPH_VIEW_H
+#define GRAPH_SUBGRAPH_VIEW_H
+
+#include <cassert>    //for assert
+#include <cstddef>    //for std::size_t, std::ptrdiff_t
+#include <iterator>   //for std::forward_iterator_tag
+#include <type_traits>    //for std::decay_t
+#include <utility>    //for std::declval, std::move
+#include <vector>     //for std::vector
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief 不复制的子图视图.
+ *
+ * subgraph_view引用一个图,并持有一个顶点谓词与一个边谓词;只有通过谓词的顶点,
+ * 以及本身通过谓词且两端顶点都通过谓词的边,才在视图中可见.谓词在遍历时才被调用,视图不保存任何结果,
+ * 因此原图的修改立即反映在视图上(与原图相同,修改时正在进行的遍历失效).
+ * 视图提供与图相同的只读接口(first_vertex/next_vertex,associated_edges,adjacent,value,index...),
+ * traversal.h中的遍历,csr_graph与compressed_graph的构造函数等按该接口编写的代码可以直接作用于视图
+ * (compressed_graph本身只提供其中的遍历部分,不能作为视图的原图).
+ */
+
+namespace lzhlib
+{
+    struct accept_all
+    {
+        template<class IdT>
+        bool operator()(IdT) const noexcept
+        {
+            return true;
+        }
+    };
+
+    //按index(id)查位图的谓词.位图由调用者持有,长度不足的部分视为false
+    class index_mask
+    {
+    public:
+        explicit index_mask(std::vector<bool> const& bits)
+            : bits(&bits)
+        {}
+        bool operator()(vertex_id v) const
+        {
+            return test(detail::id_access::to_stock_id(v).id());
+        }
+        bool operator()(edge_id e) const
+        {
+            return test(detail::id_access::to_stock_id(e).id());
+        }
+
+    private:
+        bool test(std::size_t i) const
+        {
+            return i < bits->size() && (*bits)[i];
+        }
+
+        std::vector<bool> const* bits;
+    };
+
+    template<class GraphT, class VertexPredicateT = accept_all, class EdgePredicateT = accept_all>
+    class subgraph_view
+    {
+    public:
+        using graph_t = GraphT;
+        using vertex_value_t = typename graph_t::vertex_value_t;
+        using edge_value_t = typename graph_t::edge_value_t;
+        using edge_ref_t = typename graph_t::edge_ref_t;
+        using pair_t = typename graph_t::pair_t;
+        using edge_set_t = std::decay_t<decltype(std::declval<graph_t const&>().associated_edges(std::declval<vertex_id>()))>;
+
+        static constexpr bool is_directed = graph_t::is_directed;
+
+        class edge_iterator        //跳过不可见的edge_ref
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = edge_ref_t;
+            using difference_type = std::ptrdiff_t;
+            using pointer = edge_ref_t const*;
+            using reference = edge_ref_t const&;
+
+            edge_iterator(subgraph_view const* view, typename edge_set_t::const_iterator i, typename edge_set_t::const_iterator last)
+                : view(view), i(i), last(last)
+            {
+                skip();
+            }
+
+            reference operator*() const
+            {
+                return *i;
+            }
+            pointer operator->() const
+            {
+                return &*i;
+            }
+            edge_iterator& operator++()
+            {
+                ++i;
+                skip();
+                return *this;
+            }
+            edge_iterator operator++(int)
+            {
+                edge_iterator ret = *this;
+                ++*this;
+                return ret;
+            }
+            bool operator==(edge_iterator const& rhs) const
+            {
+                return i == rhs.i;
+            }
+            bool operator!=(edge_iterator const& rhs) const
+            {
+                return i != rhs.i;
+            }
+
+        private:
+            void skip()
+            {
+                while (i != last && !view->visible(*i))
+                    ++i;
+            }
+
+            subgraph_view const* view;
+            typename edge_set_t::const_iterator i;
+            typename edge_set_t::const_iterator last;
+        };
+
+        class edge_range
+        {
+        public:
+            edge_range(edge_iterator first, edge_iterator last)
+                : first(first), last(last)
+            {}
+            edge_iterator begin() const
+            {
+                return first;
+            }
+            edge_iterator end() const
+            {
+                return last;
+            }
+            bool empty() const
+            {
+                return first == last;
+            }
+            std::size_t size() const     //O(度数)
+            {
+                std::size_t ret = 0;
+                for (auto i = first; i != last; ++i)
+                    ++ret;
+                return ret;
+            }
+
+        private:
+            edge_iterator first;
+            edge_iterator last;
+        };
+
+        subgraph_view(graph_t const& g, VertexPredicateT vertex_predicate = VertexPredicateT(),
+                      EdgePredicateT edge_predicate = EdgePredicateT())
+            : g(&g), vertex_predicate(std::move(vertex_predicate)), edge_predicate(std::move(edge_predicate))
+        {}
+
+        graph_t const& graph() const noexcept
+        {
+            return *g;
+        }
+
+        bool contains(vertex_id v) const
+        {
+            return vertex_predicate(v);
+        }
+        bool contains(edge_id e) const
+        {
+            pair_t ends = g->associated_vertices(e);
+            return edge_predicate(e) && vertex_predicate(ends.first) && vertex_predicate(ends.second);
+        }
+
+        vertex_id first_vertex() const
+        {
+            return skip_vertices(g->first_vertex());
+        }
+        bool vertex_end(vertex_id v) const
+        {
+            return g->vertex_end(v);
+        }
+        vertex_id next_vertex(vertex_id v) const
+        {
+            return skip_vertices(g->next_vertex(v));
+        }
+
+        edge_range associated_edges(vertex_id v) const   //precondition: contains(v)
+        {
+            auto const& edges = g->associated_edges(v);
+            return {edge_iterator(this, edges.begin(), edges.end()), edge_iterator(this, edges.end(), edges.end())};
+        }
+        std::vector<vertex_id> neighbors(vertex_id v) const
+        {
+            std::vector<vertex_id> ret;
+            for (edge_ref_t e : associated_edges(v))
+                ret.push_back(e.opposite_vertex());
+            return ret;
+        }
+        bool associated(vertex_id v, edge_id e) const
+        {
+            if (!contains(e))
+                return false;
+            pair_t ends = g->associated_vertices(e);
+            return ends.first == v || ends.second == v;
+        }
+        bool adjacent(vertex_id x, vertex_id y) const
+        {
+            for (edge_ref_t e : associated_edges(x))
+                if (e.opposite_vertex() == y)
+                    return true;
+            return false;
+        }
+        edge_id get_edge(vertex_id x, vertex_id y) const
+        {
+            edge_range edges = associated_edges(x);
+            auto i = edges.begin();
+            while (i != edges.end() && !(i->opposite_vertex() == y))
+                ++i;
+            assert(i != edges.end());
+            return i->edge();
+        }
+        pair_t associated_vertices(edge_id e) const
+        {
+            return g->associated_vertices(e);
+        }
+
+        vertex_value_t const& value(vertex_id v) const
+        {
+            return g->value(v);
+        }
+        edge_value_t const& value(edge_id e) const
+        {
+            return g->value(e);
+        }
+
+        std::size_t index(vertex_id v) const noexcept    //与原图相同,可直接用于按原图index排列的数组
+        {
+            return g->index(v);
+        }
+        std::size_t index(edge_id e) const noexcept
+        {
+            return g->index(e);
+        }
+        std::size_t vertex_index_bound() const noexcept
+        {
+            return g->vertex_index_bound();
+        }
+        std::size_t edge_index_bound() const noexcept
+        {
+            return g->edge_index_bound();
+        }
+
+        std::size_t vertex_count() const    //O(V)
+        {
+            std::size_t ret = 0;
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+                ++ret;
+            return ret;
+        }
+        std::size_t edge_count() const      //O(V+E)
+        {
+            std::size_t ret = 0;
+            for (auto v = first_vertex(); !vertex_end(v); v = next_vertex(v))
+                for (edge_ref_t e : associated_edges(v))
+                    if (is_directed || !(index(e.opposite_vertex()) < index(v)))
+                        ++ret;
+            return ret;
+        }
+
+    private:
+        bool visible(edge_ref_t const& r) const
+        {
+            return edge_predicate(r.edge()) && vertex_predicate(r.opposite_vertex());
+        }
+        vertex_id skip_vertices(vertex_id v) const
+        {
+            while (!g->vertex_end(v) && !vertex_predicate(v))
+                v = g->next_vertex(v);
+            return v;
+        }
+
+        graph_t const* g;
+        VertexPredicateT vertex_predicate;
+        EdgePredicateT edge_predicate;
+    };
+
+    template<class GraphT, class VertexPredicateT, class EdgePredicateT = accept_all>
+    subgraph_view<GraphT, VertexPredicateT, EdgePredicateT>
+    make_subgraph_view(GraphT const& g, VertexPredicateT vertex_predicate, EdgePredicateT edge_predicate = EdgePredicateT())
+    {
+        return {g, std::move(vertex_predicate), std::move(edge_predicate)};
+    }
+    //由满足谓词的顶点导出的子图:两端都可见的边全部可见
+    template<class GraphT, class VertexPredicateT>
+    subgraph_view<GraphT, VertexPredicateT> induced_subgraph(GraphT const& g, VertexPredicateT vertex_predicate)
+    {
+        return {g, std::move(vertex_predicate)};
+    }
+    //所有顶点可见,只过滤边
+    template<class GraphT, class EdgePredicateT>
+    subgraph_view<GraphT, accept_all, EdgePredicateT> edge_subgraph(GraphT const& g, EdgePredicateT edge_predicate)
+    {
+        return {g, accept_all(), std::move(edge_predicate)};
+    }
+}
+
+#endif //GRAPH_SUBGRAPH_VIEW_H
@@ -0,0 +1,411 @@
+#ifndef GRAPH_TRAVERSAL_H
+#define GRAPH_TRAVERSAL_H
+
+#include <cstddef>    //for std::size_t, std::ptrdiff_t
+#include <iterator>   //for std::input_iterator_tag
+#include <utility>    //for std::declval, std::move
+#include <vector>     //for std::vector
+#include "Graph/include/id_access.h"
+
+/** \file
+ *  \brief 惰性的BFS/DFS遍历.
+ *
+ * breadth_first,depth_first_preorder,depth_first_postorder,depth_first_edges返回单趟(input)range,
+ * 每次++只推进到下一个结果,因此在for循环中break即可提前结束,不必付出完整遍历的代价.
+ * 访问状态保存在按index排列的数组中,DFS使用显式栈,不递归.
+ * 适用于任何提供图的只读接口(first_vertex/next_vertex,associated_edges,index,vertex_index_bound)的类型,
+ * 包括undirected_graph,directed_graph,subgraph_view,graph_snapshot与compressed_graph.遍历期间图不应被修改.
+ */
+
+namespace lzhlib
+{
+    enum class edge_kind
+    {
+        tree,       //发现新顶点的边
+        back,       //指向DFS栈中的祖先(有环)
+        forward,    //有向图中指向已完成的后代
+        cross       //有向图中指向其它已完成的子树
+    };
+
+    struct dfs_edge
+    {
+        edge_id edge;
+        vertex_id from;
+        vertex_id to;
+        edge_kind kind;
+    };
+
+    namespace detail
+    {
+        //range与其迭代器的公共部分:迭代器只持有range的指针,range负责推进
+        template<class RangeT, class ValueT>
+        class traversal_iterator
+        {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = ValueT;
+            using difference_type = std::ptrdiff_t;
+            using pointer = ValueT const*;
+            using reference = ValueT const&;
+
+            traversal_iterator() = default;
+            explicit traversal_iterator(RangeT* range)
+                : range(range)
+            {
+                if (range != nullptr && !range->advance())
+                    this->range = nullptr;
+            }
+
+            reference operator*() const
+            {
+                return range->current();
+            }
+            pointer operator->() const
+            {
+                return &range->current();
+            }
+            traversal_iterator& operator++()
+            {
+                if (!range->advance())
+                    range = nullptr;
+                return *this;
+            }
+            void operator++(int)
+            {
+                ++*this;
+            }
+            bool operator==(traversal_iterator const& rhs) const noexcept
+            {
+                return range == rhs.range;
+            }
+            bool operator!=(traversal_iterator const& rhs) const noexcept
+            {
+                return range != rhs.range;
+            }
+
+        private:
+            RangeT* range = nullptr;
+        };
+
+        //图类型以静态成员is_directed给出方向;compressed_graph的方向在运行时才确定,由is_directed()给出
+        template<class GraphT>
+        auto is_directed_graph(GraphT const& g, int) -> decltype(static_cast<bool>(g.is_directed()))
+        {
+            return g.is_directed();
+        }
+        template<class GraphT>
+        bool is_directed_graph(GraphT const&, long)
+        {
+            return GraphT::is_directed;
+        }
+
+        enum class dfs_event
+        {
+            discover,
+            finish,
+            edge
+        };
+
+        //产生DFS事件序列(发现顶点,完成顶点,检查边)的状态机
+        template<class GraphT>
+        class dfs_engine
+        {
+        public:
+            using edge_iterator_t = decltype(std::declval<GraphT const&>().associated_edges(std::declval<vertex_id>()).begin());
+
+            dfs_engine(GraphT const& g, std::vector<vertex_id> roots, bool all_vertices)
+                : g(&g), directed(is_directed_graph(g, 0)), roots(std::move(roots)), all_vertices(all_vertices),
+                  color(g.vertex_index_bound(), white), discovered(g.vertex_index_bound(), 0),
+                  next_scan(g.first_vertex())
+            {}
+
+            //推进到下一个事件,没有更多事件时返回false
+            bool next()
+            {
+                if (pending_discover)
+                {
+                    pending_discover = false;
+                    event = dfs_event::discover;
+                    vertex = stack.back().v;
+                    return true;
+                }
+                for (;;)
+                {
+                    if (stack.empty())
+                    {
+                        if (!next_root())
+                            return false;
+                        event = dfs_event::discover;
+                        vertex = stack.back().v;
+                        return true;
+                    }
+                    frame& f = stack.back();
+                    if (f.next == f.last)
+                    {
+                        event = dfs_event::finish;
+                        vertex = f.v;
+                        color[g->index(f.v)] = black;
+                        stack.pop_back();
+                        return true;
+                    }
+                    auto r = *f.next;
+                    ++f.next;
+                    vertex_id u = r.opposite_vertex();
+                    std::size_t const iu = g->index(u);
+                    if (!directed && r.edge() == f.parent_edge)
+                        continue;                   //无向图中回到父结点的树边
+                    if (color[iu] == white)
+                    {
+                        edge = {r.edge(), f.v, u, edge_kind::tree};
+                        push(u, r.edge());
+                        pending_discover = true;
+                    }
+                    else if (color[iu] == gray)
+                        edge = {r.edge(), f.v, u, edge_kind::back};
+                    else if (!directed)
+                        continue;                   //已从另一端报告过
+                    else
+                        edge = {r.edge(), f.v, u,
+                                discovered[g->index(f.v)] < discovered[iu] ? edge_kind::forward : edge_kind::cross};
+                    event = dfs_event::edge;
+                    return true;
+                }
+            }
+
+            dfs_event event = dfs_event::discover;
+            vertex_id vertex;
+            dfs_edge edge = {no_edge(), vertex_id(), vertex_id(), edge_kind::tree};
+
+        private:
+            enum : unsigned char
+            {
+                white,      //未访问
+                gray,       //在栈中
+                black       //已完成
+            };
+            struct frame
+            {
+                vertex_id v;
+                edge_iterator_t next;
+                edge_iterator_t last;
+                edge_id parent_edge;
+            };
+
+            static edge_id no_edge()
+            {
+                return id_access::make_edge_id(static_cast<std::size_t>(-1));
+            }
+            void push(vertex_id v, edge_id parent_edge)
+            {
+                color[g->index(v)] = gray;
+                discovered[g->index(v)] = ++time;
+                auto const& edges = g->associated_edges(v);
+                stack.push_back(frame{v, edges.begin(), edges.end(), parent_edge});
+            }
+            bool next_root()
+            {
+                while (root != roots.size())
+                {
+                    vertex_id v = roots[root++];
+                    if (color[g->index(v)] == white)
+                    {
+                        push(v, no_edge());
+                        return true;
+                    }
+                }
+                if (!all_vertices)
+                    return false;
+                for (; !g->vertex_end(next_scan); next_scan = g->next_vertex(next_scan))
+                    if (color[g->index(next_scan)] == white)
+                    {
+                        push(next_scan, no_edge());
+                        return true;
+                    }
+                return false;
+            }
+
+            GraphT const* g;
+            bool directed;
+            std::vector<vertex_id> roots;
+            std::size_t root = 0;
+            bool all_vertices;
+            std::vector<unsigned char> color;
+            std::vector<std::size_t> discovered;
+            std::size_t time = 0;
+            std::vector<frame> stack;
+            bool pending_discover = false;
+            vertex_id next_scan;
+        };
+    }
+
+    template<class GraphT>
+    class bfs_range
+    {
+    public:
+        using iterator = detail::traversal_iterator<bfs_range, vertex_id>;
+
+        bfs_range(GraphT const& g, std::vector<vertex_id> const& sources)
+            : g(&g), visited(g.vertex_index_bound(), false)
+        {
+            for (vertex_id s : sources)
+                if (!visited[g.index(s)])
+                {
+                    visited[g.index(s)] = true;
+                    queue.push_back(s);
+                }
+            level_end = queue.size();
+        }
+        bfs_range(bfs_range const&) = delete;       //迭代器指向range本身
+        bfs_range(bfs_range&&) = default;
+
+        iterator begin()
+        {
+            return iterator(this);
+        }
+        iterator end()
+        {
+            return {};
+        }
+
+        std::size_t depth() const noexcept      //最近一次产生的顶点与最近的源点之间的边数
+        {
+            return depth_;
+        }
+        bool visited_vertex(vertex_id v) const  //v是否已被产生或已在队列中
+        {
+            return visited[g->index(v)];
+        }
+
+    private:
+        friend iterator;
+
+        bool advance()
+        {
+            if (head == queue.size())
+                return false;
+            if (head == level_end)
+            {
+                ++depth_;
+                level_end = queue.size();
+            }
+            current_ = queue[head++];
+            for (auto const& e : g->associated_edges(current_))
+            {
+                vertex_id u = e.opposite_vertex();
+                if (!visited[g->index(u)])
+                {
+                    visited[g->index(u)] = true;
+                    queue.push_back(u);
+                }
+            }
+            return true;
+        }
+        vertex_id const& current() const noexcept
+        {
+            return current_;
+        }
+
+        GraphT const* g;
+        std::vector<bool> visited;
+        std::vector<vertex_id> queue;
+        std::size_t head = 0;
+        std::size_t level_end = 0;
+        std::size_t depth_ = 0;
+        vertex_id current_;
+    };
+
+    //ValueT为vertex_id时产生顶点(先序或后序),为dfs_edge时产生分类后的边
+    template<class GraphT, class ValueT>
+    class dfs_range
+    {
+    public:
+        using iterator = detail::traversal_iterator<dfs_range, ValueT>;
+
+        dfs_range(GraphT const& g, std::vector<vertex_id> roots, bool all_vertices, detail::dfs_event wanted)
+            : engine(g, std::move(roots), all_vertices), wanted(wanted)
+        {}
+        dfs_range(dfs_range const&) = delete;
+        dfs_range(dfs_range&&) = default;
+
+        iterator begin()
+        {
+            return iterator(this);
+        }
+        iterator end()
+        {
+            return {};
+        }
+
+    private:
+        friend iterator;
+
+        bool advance()
+        {
+            while (engine.next())
+                if (engine.event == wanted)
+                    return true;
+            return false;
+        }
+        vertex_id const& current_of(vertex_id*) const noexcept
+        {
+            return engine.vertex;
+        }
+        dfs_edge const& current_of(dfs_edge*) const noexcept
+        {
+            return engine.edge;
+        }
+        ValueT const& current() const noexcept
+        {
+            return current_of(static_cast<ValueT*>(nullptr));
+        }
+
+        detail::dfs_engine<GraphT> engine;
+        detail::dfs_event wanted;
+    };
+
+    template<class GraphT>
+    bfs_range<GraphT> breadth_first(GraphT const& g, vertex_id source)
+    {
+        return {g, {source}};
+    }
+    template<class GraphT>
+    bfs_range<GraphT> breadth_first(GraphT const& g, std::vector<vertex_id> const& sources)
+    {
+        return {g, sources};
+    }
+
+    //从source出发;不给出source时依次从每个尚未访问的顶点出发,覆盖整个图
+    template<class GraphT>
+    dfs_range<GraphT, vertex_id> depth_first_preorder(GraphT const& g, vertex_id source)
+    {
+        return {g, {source}, false, detail::dfs_event::discover};
+    }
+    template<class GraphT>
+    dfs_range<GraphT, vertex_id> depth_first_preorder(GraphT const& g)
+    {
+        return {g, {}, true, detail::dfs_event::discover};
+    }
+    template<class GraphT>
+    dfs_range<GraphT, vertex_id> depth_first_postorder(GraphT const& g, vertex_id source)
+    {
+        return {g, {source}, false, detail::dfs_event::finish};
+    }
+    template<class GraphT>
+    dfs_range<GraphT, vertex_id> depth_first_postorder(GraphT const& g)
+    {
+        return {g, {}, true, detail::dfs_event::finish};
+    }
+    //无向图中每条边只产生一次,为tree或back
+    template<class GraphT>
+    dfs_range<GraphT, dfs_edge> depth_first_edges(GraphT const& g, vertex_id source)
+    {
+        return {g, {source}, false, detail::dfs_event::edge};
+    }
+    template<class GraphT>
+    dfs_range<GraphT, dfs_edge> depth_first_edges(GraphT const& g)
+    {
+        return {g, {}, true, detail::dfs_event::edge};
+    }
+}
+
+#endif //GRAPH_TRAVERSAL_H
@@ -3,49 +3,76 @@
 #define GRAPH_UNDIRECTED_GRAPH_H
 
 #include "Graph/include/graph_base.h"
+#include "Graph/include/mutation_batch.h"
+#include "Graph/include/adjacency_matrix.h"
 
 namespace lzhlib
 {
 
-    template<class VertexValueT, class EdgeValueT>
-    class undirected_graph : public graph_base<VertexValueT, EdgeValueT>
+    template<class VertexValueT, class EdgeValueT, class AllocatorT = std::allocator<char>, class AdjacencyT = set_adjacency>
+    class undirected_graph : public graph_base<VertexValueT, EdgeValueT, AllocatorT>
     {
+        template<class>
+        friend
+        class concurrent_graph_builder;
+
     public:
-        using base = graph_base<VertexValueT, EdgeValueT>;
-        using vertex_t = detail::vertex<VertexValueT>;
-        using vertex_value_t = typename vertex_t::vertex_value_t;
+        using base = graph_base<VertexValueT, EdgeValueT, AllocatorT>;
+        using allocator_t = typename base::allocator_t;
+        using vertex_t = typename base::vertex_t;
+        using vertex_value_t = typename base::vertex_value_t;
         using edge_ref_t = typename detail::edge_ref;
-        using edge_t = detail::edge<EdgeValueT>;
-        using edge_value_t = typename edge_t::edge_value_t;
+        using edge_t = typename base::edge_t;
+        using edge_value_t = typename base::edge_value_t;
         using pair_t = typename edge_t::pair_t;
+        using batch_t = mutation_batch<undirected_graph>;
+        using adjacency_t = AdjacencyT;
+
+        static constexpr bool is_directed = false;
+
+        using base::base;
+
+        template<class ...Args>
+        vertex_id add_vertex(Args&& ...args)
+        {
+            vertex_id v = base::add_vertex(std::forward<Args>(args)...);
+            adjacency_index.add_vertex(base::index(v));
+            return v;
+        }
 
         bool adjacent(vertex_id x, vertex_id y) const
         {
-            if (base::get_vertex(x).associated_edges().size() <
-                base::get_vertex(y).associated_edges().size())
-                return base::get_vertex(x).adjacent(y);
-            else
-                return base::get_vertex(y).adjacent(x);
+            return adjacent(x, y, indexed_t{});
+        }
+        bool associated(vertex_id v, edge_id e) const
+        {
+            return associated(v, e, indexed_t{});
+        }
+        decltype(auto) associated_edges(vertex_id v) const  //matrix_adjacency时为按相邻顶点index升序的临时range,否则为顶点的边集合
+        {
+            return associated_edges(v, indexed_t{});
+        }
+        std::vector<vertex_id> neighbors(vertex_id v) const
+        {
+            std::vector<vertex_id> ret;
+            for (edge_ref_t e : associated_edges(v))
+                ret.push_back(e.opposite_vertex());
+            return ret;
         }
 
         void remove_vertex(vertex_id v)
         {
-            auto const& edges = base::get_vertex(v).associated_edges();
-            for (edge_ref_t e : edges)
-            {
-                base::get_vertex(e.opposite_vertex()).remove_associated_edge(e.edge());
-                base::edge_repository.remove_stock(base::to_stock_id(e.edge()));
-            }
-            base::vertex_repository.remove_stock(base::to_stock_id(v));
+            unlink_vertex(v, indexed_t{});
+            adjacency_index.remove_vertex(base::index(v));
+            base::release_vertex(v);
         }
 
         template<class ...Args>
-        edge_id add_edge(vertex_id x, vertex_id y, Args&& ...args)
+        edge_id add_edge(vertex_id x, vertex_id y, Args&& ...args)  //matrix_adjacency时precondition: !adjacent(x, y)
         {
-            edge_id result = base::to_edge_id(base::edge_repository.add_stock(std::forward<Args>(args)...));
+            edge_id result = base::emplace_edge(std::forward<Args>(args)...);
             base::get_edge(result).set_associated_vertices(x, y);
-            base::get_vertex(x).add_associated_edge({result, y});
-            base::get_vertex(y).add_associated_edge({result, x});
+            link(x, y, result, indexed_t{});
             return result;
         }
         void remove_edge(vertex_id x, vertex_id y)
@@ -55,20 +82,152 @@ namespace lzhlib
         void remove_edge(edge_id e)
         {
             pair_t vertices = base::get_edge(e).associated_vertices();
-            base::get_vertex(vertices.first).remove_associated_edge(e);
-            base::get_vertex(vertices.second).remove_associated_edge(e);
-            base::edge_repository.remove_stock(base::to_stock_id(e));
+            unlink(vertices.first, vertices.second, e, indexed_t{});
+            base::release_edge(e);
+        }
+
+        std::vector<edge_id> apply(batch_t& batch)      //执行并清空batch
+        {
+            return base::apply_batch(batch, is_directed, adjacency_index);
+        }
+        id_remap compact()
+        {
+            id_remap ret = base::compact();
+            rebuild_adjacency();
+            return ret;
+        }
+        id_remap reorder(std::vector<std::size_t> vertex_map)
+        {
+            id_remap ret = base::reorder_vertices(std::move(vertex_map), [this](vertex_id v) -> decltype(auto)
+            {
+                return associated_edges(v);
+            });
+            rebuild_adjacency();
+            return ret;
         }
 
         edge_id get_edge(vertex_id x, vertex_id y) const
         {
             assert(adjacent(x, y));
+            return get_edge(x, y, indexed_t{});
+        }
+
+        bit_row neighbor_row(vertex_id v) const     //只在AdjacencyT为matrix_adjacency时可用.第i位表示index为i的顶点是否与v相邻
+        {
+            static_assert(adjacency_t::indexed, "neighbor_row() requires matrix_adjacency");
+            return adjacency_index.row(base::index(v));
+        }
+
+        graph_memory_usage memory_usage() const  //O(V)
+        {
+            graph_memory_usage ret = base::memory_usage();
+            ret.adjacency += adjacency_index.memory_usage();
+            return ret;
+        }
+
+    private:
+        using indexed_t = std::integral_constant<bool, adjacency_t::indexed>;
+
+        bool adjacent(vertex_id x, vertex_id y, std::true_type) const
+        {
+            return adjacency_index.adjacent(base::index(x), base::index(y));
+        }
+        bool adjacent(vertex_id x, vertex_id y, std::false_type) const
+        {
+            if (base::get_vertex(x).associated_edges().size() <
+                base::get_vertex(y).associated_edges().size())
+                return base::get_vertex(x).adjacent(y);
+            else
+                return base::get_vertex(y).adjacent(x);
+        }
+        bool associated(vertex_id v, edge_id e, std::true_type) const
+        {
+            pair_t ends = base::associated_vertices(e);
+            return ends.first == v || ends.second == v;
+        }
+        bool associated(vertex_id v, edge_id e, std::false_type) const
+        {
+            return base::get_vertex(v).associated(e);
+        }
+        matrix_edge_range associated_edges(vertex_id v, std::true_type) const
+        {
+            return adjacency_index.edges_of(base::index(v));
+        }
+        auto const& associated_edges(vertex_id v, std::false_type) const
+        {
+            return base::associated_edges(v);
+        }
+        edge_id get_edge(vertex_id x, vertex_id y, std::true_type) const
+        {
+            return adjacency_index.edge(base::index(x), base::index(y));
+        }
+        edge_id get_edge(vertex_id x, vertex_id y, std::false_type) const
+        {
             if (base::get_vertex(x).associated_edges().size() <
                 base::get_vertex(y).associated_edges().size())
                 return base::get_vertex(x).associated_edge(y);
             else
                 return base::get_vertex(y).associated_edge(x);
         }
+        void link(vertex_id x, vertex_id y, edge_id e, std::true_type)
+        {
+            adjacency_index.add_edge(base::index(x), base::index(y), e, is_directed);
+        }
+        void link(vertex_id x, vertex_id y, edge_id e, std::false_type)
+        {
+            base::get_vertex(x).add_associated_edge({e, y});
+            base::get_vertex(y).add_associated_edge({e, x});
+        }
+        void unlink(vertex_id x, vertex_id y, edge_id, std::true_type)
+        {
+            adjacency_index.remove_edge(base::index(x), base::index(y), is_directed);
+        }
+        void unlink(vertex_id x, vertex_id y, edge_id e, std::false_type)
+        {
+            base::get_vertex(x).remove_associated_edge(e);
+            if (!(x == y))
+                base::get_vertex(y).remove_associated_edge(e);
+        }
+        void unlink_vertex(vertex_id v, std::true_type)     //行与列由adjacency_index.remove_vertex清除
+        {
+            adjacency_index.for_each_incident_edge(base::index(v), is_directed, [this](edge_id e)
+            {
+                base::release_edge(e);
+            });
+        }
+        void unlink_vertex(vertex_id v, std::false_type)
+        {
+            auto const& edges = base::get_vertex(v).associated_edges();
+            for (edge_ref_t e : edges)
+            {
+                base::get_vertex(e.opposite_vertex()).remove_associated_edge(e.edge());
+                base::release_edge(e.edge());
+            }
+        }
+        void rebuild_adjacency()    //编号被整体修改后按边重建矩阵.O(V^2+E)
+        {
+            rebuild_adjacency(indexed_t{});
+        }
+        void rebuild_adjacency(std::false_type)
+        {}
+        void rebuild_adjacency(std::true_type)
+        {
+            adjacency_index = adjacency_t();
+            for (auto v = base::first_vertex(); !base::vertex_end(v); v = base::next_vertex(v))
+                adjacency_index.add_vertex(base::index(v));
+            for (auto e = base::edge_repository.first_stock(); !base::edge_repository.stock_end(e);
+                 e = base::edge_repository.next_stock(e))
+            {
+                pair_t ends = base::edge_repository.get_stock(e).associated_vertices();
+                adjacency_index.add_edge(base::index(ends.first), base::index(ends.second), detail::id_access::make_edge_id(e),
+                                         is_directed);
+            }
+        }
+
+        adjacency_t adjacency_index;
     };
+
+    template<class VertexValueT, class EdgeValueT, class AllocatorT = std::allocator<char>>
+    using dense_undirected_graph = undirected_graph<VertexValueT, EdgeValueT, AllocatorT, matrix_adjacency>;
 }
 #endif //GRAPH_UNDIRECTED_GRAPH_H
@@ -0,0 +1,183 @@
+#ifndef GRAPH_VALUE_COLUMN_H
+#define GRAPH_VALUE_COLUMN_H
+
+#include <cstddef>        //for std::size_t
+#include <memory>         //for std::allocator_traits
+#include <type_traits>    //for std::true_type, std::false_type, std::is_same
+#include <utility>        //for std::forward
+#include <vector>         //for std::vector
+#include "Graph/include/stock_id.h"
+
+namespace lzhlib
+{
+    class null_value_tag;
+
+    /*
+     * 以columnar<T>作为VertexValueT或EdgeValueT时,值不再与拓扑结构存放在同一个对象中,
+     * 而是按下标(graph.index(id))存放在一个连续的数组里,可通过vertex_values()/edge_values()整列访问.
+     * T须可默认构造与移动赋值:被删除的顶点/边所在的位置会被重置为T().
+     * T不能是bool:std::vector<bool>按位存放,无法给出连续的bool数组与bool&,需要时用columnar<unsigned char>代替.
+     */
+    template<class ValueT>
+    struct columnar
+    {
+    };
+
+    template<class T>
+    class column_span        //a non-owning view over a contiguous column
+    {
+    public:
+        using value_type = std::remove_const_t<T>;
+        using iterator = T*;
+
+        column_span(T* data, std::size_t size) noexcept
+            : data_(data), size_(size)
+        {}
+
+        T* data() const noexcept
+        {
+            return data_;
+        }
+        std::size_t size() const noexcept
+        {
+            return size_;
+        }
+        bool empty() const noexcept
+        {
+            return size_ == 0;
+        }
+        T& operator[](std::size_t i) const noexcept
+        {
+            return data_[i];
+        }
+        iterator begin() const noexcept
+        {
+            return data_;
+        }
+        iterator end() const noexcept
+        {
+            return data_ + size_;
+        }
+
+    private:
+        T* data_;
+        std::size_t size_;
+    };
+
+    namespace detail
+    {
+        struct empty_value
+        {
+        };
+        template<class ValueT>
+        struct storable_value       //null_value_tag只有声明,需要实际存放值的地方用empty_value代替
+        {
+            using type = ValueT;
+        };
+        template<>
+        struct storable_value<null_value_tag>
+        {
+            using type = empty_value;
+        };
+
+        template<class ValueT>
+        struct value_layout
+        {
+            using value_t = ValueT;
+            using stored_t = ValueT;        //the type kept inside vertex/edge
+            using is_columnar = std::false_type;
+        };
+        template<class ValueT>
+        struct value_layout<columnar<ValueT>>
+        {
+            using value_t = ValueT;
+            using stored_t = null_value_tag;
+            using is_columnar = std::true_type;
+        };
+
+        template<class ValueT, class AllocatorT>
+        class value_column
+        {
+        public:
+            using value_t = ValueT;
+            using allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<value_t>;
+            static_assert(!std::is_same<value_t, bool>::value,
+                          "columnar<bool> is not supported because std::vector<bool> is not contiguous; use columnar<unsigned char>");
+
+            explicit value_column(AllocatorT const& a)
+                : values(allocator_t(a))
+            {}
+
+            template<class ...Args>
+            void emplace(stock_id id, Args&& ... args)   //precondition: id.id() <= size(),即id是新分配的或复用的slot
+            {
+                if (id.id() == values.size())
+                    values.emplace_back(std::forward<Args>(args)...);
+                else
+                    values[id.id()] = value_t(std::forward<Args>(args)...);
+            }
+            void reset(stock_id id)
+            {
+                values[id.id()] = value_t();
+            }
+            void renumber(std::vector<std::size_t> const& new_index, std::size_t new_size) //已删除的位置在new_index中须不小于new_size
+            {
+                std::vector<value_t, allocator_t> renumbered(values.get_allocator());
+                renumbered.resize(new_size);
+                for (std::size_t i = 0; i != values.size(); ++i)
+                    if (new_index[i] < new_size)
+                        renumbered[new_index[i]] = std::move(values[i]);
+                values.swap(renumbered);
+            }
+
+            value_t& operator[](stock_id id)
+            {
+                return values[id.id()];
+            }
+            value_t const& operator[](stock_id id) const
+            {
+                return values[id.id()];
+            }
+
+            column_span<value_t> span() noexcept
+            {
+                return {values.data(), values.size()};
+            }
+            column_span<value_t const> span() const noexcept
+            {
+                return {values.data(), values.size()};
+            }
+
+            std::size_t memory_usage() const noexcept
+            {
+                return values.capacity() * sizeof(value_t);
+            }
+
+        private:
+            std::vector<value_t, allocator_t> values;
+        };
+
+        template<class AllocatorT>
+        class no_value_column     //values are stored inline, nothing to do here
+        {
+        public:
+            explicit no_value_column(AllocatorT const&)
+            {}
+            void reset(stock_id)
+            {}
+            void renumber(std::vector<std::size_t> const&, std::size_t)
+            {}
+            std::size_t memory_usage() const noexcept
+            {
+                return 0;
+            }
+        };
+
+        template<class ValueT, class AllocatorT>
+        using value_column_for = std::conditional_t<value_layout<ValueT>::is_columnar::value,
+                                                    value_column<typename value_layout<ValueT>::value_t, AllocatorT>,
+                                                    no_value_column<AllocatorT>>;
+    }
+}
+
+#endif //GRAPH_VALUE_COLUMN_H
@@ -2,11 +2,17 @@
 #ifndef GRAPH_VERTEX_H
 #define GRAPH_VERTEX_H
 
+#include <algorithm>     //for std::merge, std::set_difference
 #include <functional>    //for std::less
+#include <iterator>      //for std::distance, std::inserter
+#include <memory>        //for std::allocator, std::allocator_traits, std::allocator_arg_t
 #include <set>           //for std::set
 #include <stdexcept>     //for std::logic_error
+#include <type_traits>   //for std::enable_if_t, std::decay_t
+#include <vector>        //for std::vector
 #include "Graph/include/edge_id.h"
 #include "Graph/include/vertex_id.h"
+#include "Graph/include/instrumentation.h"
 
 namespace lzhlib
 {
@@ -81,15 +87,32 @@ namespace lzhlib
         }
 
 
-        template<class VertexValueT = null_value_tag>
+        template<class ...Args>
+        struct starts_with_allocator_arg : std::false_type
+        {
+        };
+        template<class First, class ...Rest>
+        struct starts_with_allocator_arg<First, Rest...>
+            : std::is_same<std::decay_t<First>, std::allocator_arg_t>
+        {
+        };
+
+        template<class VertexValueT = null_value_tag, class AllocatorT = std::allocator<edge_ref>>
         class vertex;
 
-        template<>
-        class vertex<null_value_tag>
+        template<class AllocatorT>
+        class vertex<null_value_tag, AllocatorT>
         {
 
         public:
             using vertex_value_t = null_value_tag;
+            using allocator_t = typename std::allocator_traits<AllocatorT>::template rebind_alloc<edge_ref>;
+            using edge_set_t = std::set<edge_ref, std::less<void>, allocator_t>;
+
+            vertex() = default;
+            vertex(std::allocator_arg_t, allocator_t const& a)     //邻接集合的结点从a中分配
+                : edges(a)
+            {}
 
 //            bool is_associated(edge_id i)
 //            {
@@ -101,23 +124,83 @@ namespace lzhlib
             }
             void add_associated_edge(edge_ref i)
             {
+                LZHLIB_GRAPH_TIME(adjacency_insert);
+                LZHLIB_GRAPH_COUNT(adjacency_inserts, 1);
                 edges.insert(i);
             }
+            template<class ForwardIt>
+            void add_associated_edges_sorted(ForwardIt first, ForwardIt last)  //precondition: [first,last)按edge_id升序,且与已有的edge_ref不重复
+            {
+                auto count = static_cast<std::size_t>(std::distance(first, last));
+                LZHLIB_GRAPH_TIME(adjacency_insert);
+                LZHLIB_GRAPH_COUNT(adjacency_inserts, count);
+                if (count >= edges.size() / bulk_threshold)
+                {                                           //merge into a fresh tree; every insertion hits the end hint
+                    edge_set_t merged(edges.get_allocator());
+                    std::merge(edges.begin(), edges.end(), first, last, std::inserter(merged, merged.end()));
+                    edges.swap(merged);
+                }
+                else
+                {
+                    for (; first != last; ++first)
+                        edges.insert(*first);
+                }
+            }
+            template<class ForwardIt>
+            void remove_associated_edges_sorted(ForwardIt first, ForwardIt last)  //precondition: [first,last)为按升序排列的已关联的edge_id
+            {
+                auto count = static_cast<std::size_t>(std::distance(first, last));
+                LZHLIB_GRAPH_TIME(adjacency_erase);
+                LZHLIB_GRAPH_COUNT(adjacency_erases, count);
+                if (count >= edges.size() / bulk_threshold)
+                {
+                    edge_set_t kept(edges.get_allocator());
+                    std::set_difference(edges.begin(), edges.end(), first, last,
+                                        std::inserter(kept, kept.end()), std::less<void>());
+                    edges.swap(kept);
+                }
+                else
+                {
+                    for (; first != last; ++first)
+                        edges.erase(edges.find(*first));
+                }
+            }
+            template<class F>
+            void rewrite_associated_edges(F f)    //把每个edge_ref替换为f(edge_ref),用于重新编号
+            {
+                std::vector<edge_ref> rewritten;
+                rewritten.reserve(edges.size());
+                for (edge_ref e : edges)
+                    rewritten.push_back(f(e));
+                std::sort(rewritten.begin(), rewritten.end());
+                edge_set_t rebuilt(edges.get_allocator());
+                for (edge_ref e : rewritten)
+                    rebuilt.insert(rebuilt.end(), e);
+                edges.swap(rebuilt);
+            }
             void remove_associated_edge(edge_id i)
             {
+                LZHLIB_GRAPH_TIME(adjacency_erase);
+                LZHLIB_GRAPH_COUNT(adjacency_erases, 1);
                 auto to_be_erased = edges.find(i);
                 edges.erase(to_be_erased);
             }
 
             bool adjacent(vertex_id v) const
             {
-                auto const& edges = associated_edges();
-                if (edges.find(v) != edges.end())
-                    return true;
+                LZHLIB_GRAPH_COUNT(adjacency_lookups, 1);
+                auto const& edges = associated_edges();       //edges按edge_id排序,不能按opposite_vertex()查找
+                for (edge_ref e : edges)
+                {
+                    LZHLIB_GRAPH_COUNT(adjacency_scan_length, 1);
+                    if (e.is_connected(v))
+                        return true;
+                }
                 return false;
             }
             bool associated(edge_id e) const
             {
+                LZHLIB_GRAPH_COUNT(adjacency_lookups, 1);
                 auto const& edges = associated_edges();
                 if (edges.find(e) != edges.end())
                     return true;
@@ -129,6 +212,7 @@ namespace lzhlib
                 auto const& edges = associated_edges();
                 for (edge_ref e : edges)
                 {
+                    LZHLIB_GRAPH_COUNT(adjacency_scan_length, 1);
                     if (e.is_connected(y))
                         return e.edge();
                 }
@@ -136,20 +220,29 @@ namespace lzhlib
             }
 
         private:
-            std::set<edge_ref, std::less<void>> edges;  //for std::less<void>::is_transparent  --> for comparision between differnet types
+            static constexpr std::size_t bulk_threshold = 8;   //批量修改的数目不少于集合大小的1/8时,重建集合而不是逐个修改
+
+            edge_set_t edges;  //for std::less<void>::is_transparent  --> for comparision between differnet types
         };
 
-        template<class VertexValueT>
-        class vertex : public vertex<null_value_tag>
+        template<class VertexValueT, class AllocatorT>
+        class vertex : public vertex<null_value_tag, AllocatorT>
         {
         public:
             using vertex_value_t = VertexValueT;
+            using allocator_t = typename vertex<null_value_tag, AllocatorT>::allocator_t;
 
-            template<class ...Args>
+            template<class ...Args, class = std::enable_if_t<!starts_with_allocator_arg<Args...>::value>>
             vertex(Args&& ... args)
                 : value(std::forward<Args>(args)...)
             {
 
+            }
+            template<class ...Args>
+            vertex(std::allocator_arg_t, allocator_t const& a, Args&& ... args)
+                : vertex<null_value_tag, AllocatorT>(std::allocator_arg, a), value(std::forward<Args>(args)...)
+            {
+
             }
 
             vertex_value_t& vertex_value()&
@@ -7,11 +7,17 @@
 namespace lzhlib
 {
 
+    namespace detail
+    {
+        struct id_access;
+    }
+
     class vertex_id
     {
         friend struct invalid_vertex;
+        friend struct detail::id_access;
 
-        template<class, class>
+        template<class, class, class>
         friend
         class graph_base;
 
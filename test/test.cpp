@@ -1,7 +1,24 @@
 #include <iostream>
 #include <cassert>
+#include <atomic>
+#include <thread>
+#include <cmath>
+#include <sstream>
 
 #include "Graph/include/graph.h"
+#include "Graph/include/concurrent_graph.h"
+#include "Graph/include/graph_builder.h"
+#include "Graph/include/reorder.h"
+#include "Graph/include/compressed_graph.h"
+#include "Graph/include/subgraph_view.h"
+#include "Graph/include/persistent_graph.h"
+#include "Graph/include/traversal.h"
+#include "Graph/include/multi_source_bfs.h"
+#include "Graph/include/betweenness.h"
+#include "Graph/include/reachability.h"
+#include "Graph/include/keyed_graph.h"
+#include "Graph/include/partition.h"
+#include "Graph/include/random_walk.h"
 #include "Graph/test/white_box_test.h"
 
 using namespace std;
@@ -169,11 +186,1447 @@ void test_directed_graph()
     g.remove_vertex(v1);
 }
 
+void test_memory_usage_and_instrumentation()
+{
+    instrumentation::reset();
+    undirected_graph<int, double> g;
+    assert(g.memory_usage().total() == 0);
+    vertex_id v0 = g.add_vertex(0);
+    vertex_id v1 = g.add_vertex(1);
+    vertex_id v2 = g.add_vertex(2);
+    g.add_edge(v0, v1, 0.5);
+    g.add_edge(v1, v2, 1.5);
+    assert(g.vertex_count() == 3);
+    assert(g.edge_count() == 2);
+
+    graph_memory_usage usage = g.memory_usage();
+    assert(usage.values == 3 * sizeof(int) + 2 * sizeof(double));
+    assert(usage.adjacency > 0 && usage.vertex_store > 0 && usage.edge_store > 0);
+    assert(usage.total() == usage.vertex_store + usage.edge_store + usage.adjacency + usage.values);
+
+    g.remove_vertex(v1);
+    assert(g.vertex_count() == 2);
+    assert(g.edge_count() == 0);
+    assert(g.memory_usage().adjacency == 0);
+
+    instrumentation::statistics stats = instrumentation::snapshot();
+    if (instrumentation::enabled)
+    {
+        assert(stats.value(instrumentation::counter::stock_allocations) == 5);
+        assert(stats.value(instrumentation::counter::adjacency_inserts) == 4);
+        assert(stats.value(instrumentation::counter::adjacency_erases) == 2);
+        assert(stats.calls(instrumentation::timer::adjacency_insert) == 4);
+    }
+    else
+    {
+        assert(stats.value(instrumentation::counter::stock_allocations) == 0);
+    }
+}
+
+void test_allocator()
+{
+    static_assert(sizeof(repository<int>::pointer_t) == sizeof(int*), "empty allocators must not enlarge the slots");
+    monotonic_arena arena;
+    {
+        using allocator = arena_allocator<char>;
+        undirected_graph<std::string, int, allocator> g{allocator(arena)};
+        vertex_id v0 = g.add_vertex("v0");
+        vertex_id v1 = g.add_vertex("v1");
+        vertex_id v2 = g.add_vertex("v2");
+        std::size_t after_vertices = arena.bytes_allocated();
+        assert(after_vertices > 0);
+        edge_id e0 = g.add_edge(v0, v1, 1);
+        g.add_edge(v1, v2, 2);
+        assert(arena.bytes_allocated() > after_vertices);
+        assert(g.get_allocator() == allocator(arena));
+        assert(g.value(e0) == 1);
+        assert(g.adjacent(v1, v0) && g.adjacent(v1, v2));
+        g.remove_vertex(v1);
+        assert(!g.adjacent(v0, v2));
+        assert(g.value(v2) == "v2");
+    }
+    arena.release();
+    assert(arena.bytes_allocated() == 0);
+}
+
+void test_null_value_edges()
+{
+    undirected_graph<int, null_value_tag> g;
+    vertex_id v0 = g.add_vertex(0);
+    vertex_id v1 = g.add_vertex(1);
+    vertex_id v2 = g.add_vertex(2);
+    edge_id e0 = g.add_edge(v0, v1);
+    edge_id e1 = g.add_edge(v1, v2);
+    assert(g.associated_vertices(e0).first == v0 && g.associated_vertices(e0).second == v1);
+    assert(g.get_edge(v2, v1) == e1);
+    assert(g.edge_count() == 2);
+    assert(g.memory_usage().values == 3 * sizeof(int));
+
+    g.remove_edge(e0);
+    assert(!g.adjacent(v0, v1));
+    edge_id e2 = g.add_edge(v2, v0);                 //reuses the slot of e0
+    assert(g.associated_vertices(e2).first == v2 && g.associated_vertices(e2).second == v0);
+    assert(g.associated_vertices(e1).first == v1);
+    assert(g.edge_count() == 2);
+
+    undirected_graph<int, int> weighted;
+    vertex_id w0 = weighted.add_vertex(0);
+    vertex_id w1 = weighted.add_vertex(1);
+    weighted.add_edge(w0, w1, 0);
+    weighted.add_edge(w1, w0, 1);
+    assert(g.memory_usage().edge_store < weighted.memory_usage().edge_store);
+
+    g.remove_vertex(v1);
+    assert(g.edge_count() == 1);
+    assert(g.adjacent(v0, v2));
+
+    directed_graph<null_value_tag, null_value_tag> topology;
+    vertex_id a = topology.add_vertex();
+    vertex_id b = topology.add_vertex();
+    edge_id ab = topology.add_edge(a, b);
+    assert(topology.adjacent(a, b) && !topology.adjacent(b, a));
+    assert(topology.get_edge(a, b) == ab);
+    assert(topology.memory_usage().values == 0);
+
+    //空出的slot与repository一样从低到高复用,边的id与是否带值无关
+    vertex_id c = topology.add_vertex();
+    edge_id bc = topology.add_edge(b, c);
+    edge_id ca = topology.add_edge(c, a);
+    topology.remove_edge(ab);
+    topology.remove_edge(ca);
+    assert(topology.add_edge(a, c) == ab);
+    assert(topology.add_edge(c, b) == ca);
+    assert(topology.add_edge(b, a) != bc);
+}
+
+void test_columnar_values()
+{
+    undirected_graph<columnar<double>, columnar<int>> g;
+    vertex_id v0 = g.add_vertex(1.0);
+    vertex_id v1 = g.add_vertex(2.0);
+    vertex_id v2 = g.add_vertex(4.0);
+    edge_id e0 = g.add_edge(v0, v1, 10);
+    edge_id e1 = g.add_edge(v1, v2, 20);
+    assert(g.value(v1) == 2.0);
+    assert(g.value(e1) == 20);
+    g.value(e0) = 15;
+    assert(const_cast<decltype(g) const&>(g).value(e0) == 15);
+
+    auto weights = g.vertex_values();
+    assert(weights.size() == g.vertex_index_bound());
+    assert(weights[g.index(v2)] == 4.0);
+    double sum = 0;
+    for (double w : weights)
+        sum += w;
+    assert(sum == 7.0);
+
+    g.remove_vertex(v0);                    //removed slots are reset to T()
+    sum = 0;
+    for (double w : const_cast<decltype(g) const&>(g).vertex_values())
+        sum += w;
+    assert(sum == 6.0);
+    assert(g.edge_values()[g.index(e1)] == 20);
+    assert(g.edge_values()[g.index(e0)] == 0);
+#ifndef NDEBUG
+    bool thrown = false;                    //debug下读取已删除顶点的值与非列式布局一样抛出异常
+    try
+    {
+        g.value(v0);
+    }
+    catch (std::out_of_range const&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+#endif // NDEBUG
+
+    vertex_id v3 = g.add_vertex(8.0);       //reuses the slot of v0
+    assert(g.index(v3) == g.index(v0));
+    assert(g.value(v3) == 8.0);
+    assert(g.memory_usage().values >= 3 * sizeof(double) + 2 * sizeof(int));
+
+    directed_graph<columnar<std::string>, std::string> d;
+    vertex_id a = d.add_vertex("a");
+    vertex_id b = d.add_vertex("b");
+    edge_id ab = d.add_edge(a, b, "ab");
+    assert(d.value(a) == "a" && d.value(ab) == "ab");
+    assert(d.vertex_values()[d.index(b)] == "b");
+}
+
+void test_concurrent_graph()
+{
+    concurrent_undirected_graph<int, int> g;
+    vertex_id v0 = g.add_vertex(0);
+    vertex_id v1 = g.add_vertex(1);
+    edge_id e0 = g.add_edge(v0, v1, 10);
+    {
+        auto r = g.read();
+        assert(r->vertex_count() == 0);           //nothing published yet
+    }
+    g.publish();
+    {
+        auto before = g.read();
+        g.value(v0) = 5;
+        g.remove_edge(e0);
+        g.publish();
+        auto after = g.read();
+        assert(before->adjacent(v0, v1) && before->value(v0) == 0 && before->value(e0) == 10);
+        assert(!after->adjacent(v0, v1) && after->value(v0) == 5);
+        assert(after->version() == before->version() + 1);
+        assert(g.pending_reclamations() > 0);
+    }
+    g.reclaim();
+    assert(g.pending_reclamations() == 0);
+
+    std::vector<vertex_id> ring;
+    for (int i = 0; i != 64; ++i)
+        ring.push_back(g.add_vertex(i));
+    g.publish();
+
+    std::atomic<bool> done{false};
+    std::atomic<bool> consistent{true};
+    auto reader = [&]
+    {
+        std::uint64_t last_version = 0;
+        while (!done.load())
+        {
+            auto r = g.read();
+            if (r->version() < last_version)
+                consistent = false;
+            last_version = r->version();
+            std::size_t degrees = 0;
+            for (auto v = r->first_vertex(); !r->vertex_end(v); v = r->next_vertex(v))
+            {
+                for (auto e : r->associated_edges(v))
+                {
+                    auto ends = r->associated_vertices(e.edge());
+                    if (!(ends.first == v || ends.second == v))
+                        consistent = false;
+                }
+                degrees += r->associated_edges(v).size();
+            }
+            if (degrees != 2 * r->edge_count())
+                consistent = false;
+        }
+    };
+    std::vector<std::thread> readers;
+    for (int i = 0; i != 4; ++i)
+        readers.emplace_back(reader);
+    for (int round = 0; round != 20; ++round)
+    {
+        for (std::size_t i = 0; i != ring.size(); ++i)
+            g.add_edge(ring[i], ring[(i + 1 + round) % ring.size()], round);
+        g.publish();
+        if (round % 2 == 1)
+        {
+            g.remove_vertex(ring[round]);
+            ring[round] = g.add_vertex(round);
+            g.publish();
+        }
+    }
+    done = true;
+    for (auto& t : readers)
+        t.join();
+    assert(consistent.load());
+    g.reclaim();
+    assert(g.pending_reclamations() == 0);
+    assert(g.read()->vertex_count() == 66);
+}
+
+void test_concurrent_builder()
+{
+    using graph_t = undirected_graph<int, int>;
+    concurrent_graph_builder<graph_t> builder;
+    int const per_thread = 2000;
+    int const thread_count = 4;
+    std::vector<std::vector<vertex_id>> ids(thread_count);
+    std::vector<std::thread> threads;
+    for (int t = 0; t != thread_count; ++t)
+        threads.emplace_back([&, t]
+                             {
+                                 for (int i = 0; i != per_thread; ++i)
+                                     ids[t].push_back(builder.add_vertex(t * per_thread + i));
+                                 for (int i = 1; i != per_thread; ++i)
+                                     builder.add_edge(ids[t][i - 1], ids[t][i], t);
+                             });
+    for (auto& t : threads)
+        t.join();
+    threads.clear();
+    for (int t = 1; t != thread_count; ++t)   //hubs touched concurrently from every thread
+        threads.emplace_back([&, t] { builder.add_edge(ids[0][0], ids[t][0], -1); });
+    for (auto& t : threads)
+        t.join();
+
+    graph_t g = builder.finalize();
+    assert(g.vertex_count() == std::size_t(thread_count * per_thread));
+    assert(g.edge_count() == std::size_t(thread_count * (per_thread - 1) + thread_count - 1));
+    for (int t = 0; t != thread_count; ++t)
+    {
+        assert(g.value(ids[t][5]) == t * per_thread + 5);
+        edge_id e = g.get_edge(ids[t][5], ids[t][6]);
+        assert(g.value(e) == t);
+        assert(g.associated_edges(ids[t][7]).size() == 2);
+    }
+    assert(g.associated_edges(ids[0][0]).size() == std::size_t(thread_count));
+    assert(g.adjacent(ids[2][0], ids[0][0]));
+
+    concurrent_graph_builder<directed_graph<null_value_tag, null_value_tag>> topology;
+    vertex_id a = topology.add_vertex();
+    vertex_id b = topology.add_vertex();
+    topology.add_edge(a, b);
+    auto d = topology.finalize();
+    assert(d.adjacent(a, b) && !d.adjacent(b, a));
+
+    struct picky                                //构造时抛出异常的值不占用id
+    {
+        explicit picky(int x)
+            : x(x)
+        {
+            if (x < 0)
+                throw std::invalid_argument("negative");
+        }
+        int x;
+    };
+    concurrent_graph_builder<undirected_graph<picky, picky>> careful;
+    vertex_id p0 = careful.add_vertex(0);
+    bool thrown = false;
+    try
+    {
+        careful.add_vertex(-1);
+    }
+    catch (std::invalid_argument const&)
+    {
+        thrown = true;
+    }
+    assert(thrown && careful.vertex_count() == 1);
+    vertex_id p1 = careful.add_vertex(1);
+    careful.add_edge(p0, p1, 2);
+    auto pg = careful.finalize();
+    assert(pg.vertex_count() == 2 && pg.value(p1).x == 1 && pg.value(pg.get_edge(p0, p1)).x == 2);
+}
+
+void test_mutation_batch()
+{
+    undirected_graph<int, int> g;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 40; ++i)
+        v.push_back(g.add_vertex(i));
+    vertex_id hub = v[0];
+    std::vector<edge_id> spokes;
+    for (int i = 1; i != 40; ++i)
+        spokes.push_back(g.add_edge(hub, v[i], i));
+    edge_id rim = g.add_edge(v[1], v[2], 100);
+
+    undirected_graph<int, int>::batch_t batch;
+    batch.remove_vertex(hub);                   //drops 39 spokes in one pass per endpoint
+    batch.remove_edge(spokes[0]);               //already implied by the hub removal
+    batch.add_edge(v[1], v[3], 13);
+    batch.add_edge(v[3], v[3], 33);
+    batch.add_edge(v[2], v[3], 23);
+    assert(batch.size() == 5);
+    assert(g.adjacent(hub, v[5]));              //nothing happens before apply
+
+    std::vector<edge_id> added = g.apply(batch);
+    assert(batch.empty());
+    assert(added.size() == 3);
+    assert(g.vertex_count() == 39);
+    assert(g.edge_count() == 4);
+    assert(g.value(added[0]) == 13 && g.value(added[2]) == 23);
+    assert(g.adjacent(v[1], v[3]) && g.adjacent(v[3], v[2]));
+    assert(g.get_edge(v[2], v[1]) == rim);
+    assert(g.associated_edges(v[3]).size() == 3);
+    assert(g.associated_edges(v[5]).empty());
+
+    batch.remove_edge(rim);
+    batch.remove_edge(added[1]);
+    g.apply(batch);
+    assert(!g.adjacent(v[1], v[2]));
+    assert(g.associated_edges(v[3]).size() == 2);
+
+    directed_graph<null_value_tag, null_value_tag> d;
+    vertex_id a = d.add_vertex();
+    vertex_id b = d.add_vertex();
+    directed_graph<null_value_tag, null_value_tag>::batch_t db;
+    db.add_edge(a, b);
+    db.add_edge(b, a);
+    auto ids = d.apply(db);
+    assert(d.get_edge(a, b) == ids[0] && d.get_edge(b, a) == ids[1]);
+    db.remove_edge(ids[0]);
+    d.apply(db);
+    assert(!d.adjacent(a, b) && d.adjacent(b, a));
+}
+
+void test_compact()
+{
+    undirected_graph<std::string, columnar<int>> g;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 10; ++i)
+        v.push_back(g.add_vertex(std::to_string(i)));
+    std::vector<edge_id> e;
+    for (int i = 0; i + 1 != 10; ++i)
+        e.push_back(g.add_edge(v[i], v[i + 1], i));
+    edge_id chord = g.add_edge(v[9], v[3], 93);
+    for (int i : {0, 2, 5, 6})
+        g.remove_vertex(v[i]);
+    assert(g.vertex_index_bound() == 10);
+
+    id_remap remap = g.compact();
+    assert(g.vertex_index_bound() == 6 && g.vertex_count() == 6);
+    assert(g.edge_index_bound() == g.edge_count());
+    assert(!remap.contains(v[0]) && remap(v[2]) == invalid_vertex_id);
+    for (int i : {1, 3, 4, 7, 8, 9})
+        assert(g.value(remap(v[i])) == std::to_string(i));
+    assert(g.index(remap(v[1])) == 0 && g.index(remap(v[9])) == 5);
+    assert(!remap.contains(e[0]) && remap.contains(e[3]));
+    assert(g.value(remap(e[3])) == 3);
+    assert(g.get_edge(remap(v[3]), remap(v[4])) == remap(e[3]));
+    assert(g.get_edge(remap(v[3]), remap(v[9])) == remap(chord));
+    assert(g.associated_vertices(remap(chord)).first == remap(v[9]));
+    assert(g.associated_edges(remap(v[1])).empty());
+    assert(g.edge_values()[g.index(remap(e[8]))] == 8);
+
+    vertex_id fresh = g.add_vertex("fresh");        //no holes left, so ids grow again
+    assert(g.index(fresh) == 6);
+    g.add_edge(fresh, remap(v[1]), 61);
+    assert(g.adjacent(remap(v[1]), fresh));
+}
+
+namespace
+{
+    bool is_permutation_of_size(vertex_order const& p, std::size_t n)
+    {
+        std::vector<bool> seen(n, false);
+        for (auto i : p)
+        {
+            if (i >= n || seen[i])
+                return false;
+            seen[i] = true;
+        }
+        return p.size() == n;
+    }
+    std::size_t bandwidth(csr_graph const& g)
+    {
+        std::size_t ret = 0;
+        for (csr_graph::index_t v = 0; v != g.vertex_count(); ++v)
+            for (auto u : g.neighbors(v))
+                ret = std::max<std::size_t>(ret, u > v ? u - v : v - u);
+        return ret;
+    }
+}
+
+void test_reorder()
+{
+    //一条路径,但顶点按打乱的顺序插入
+    int const label[] = {7, 2, 9, 0, 5, 3, 8, 1, 6, 4};
+    undirected_graph<int, int> g;
+    std::vector<vertex_id> by_label(10);
+    for (int l : label)
+        by_label[l] = g.add_vertex(l);
+    std::vector<edge_id> e;
+    for (int l = 0; l + 1 != 10; ++l)
+        e.push_back(g.add_edge(by_label[l], by_label[l + 1], l));
+    vertex_id lonely = g.add_vertex(100);
+
+    csr_graph csr(g);
+    assert(csr.vertex_count() == 11 && csr.entry_count() == 18);
+    assert(csr.vertex(csr.dense_index(by_label[5])) == by_label[5]);
+    assert(bandwidth(csr) > 1);
+
+    for (auto const& p : {reverse_cuthill_mckee(csr), degree_descending(csr), hub_clustering(csr), gorder(csr)})
+    {
+        assert(is_permutation_of_size(p, 11));
+        csr_graph q = csr.permuted(p);
+        assert(q.entry_count() == csr.entry_count());
+        for (csr_graph::index_t v = 0; v != 11; ++v)
+        {
+            assert(q.vertex(p[v]) == csr.vertex(v) && q.dense_index(csr.vertex(v)) == p[v]);
+            assert(q.degree(p[v]) == csr.degree(v));
+        }
+    }
+    vertex_order rcm = reverse_cuthill_mckee(csr);
+    assert(bandwidth(csr.permuted(rcm)) == 1);
+    assert(degree_descending(csr)[csr.dense_index(lonely)] == 10);
+    assert(bandwidth(csr.permuted(gorder(csr))) < bandwidth(csr));
+
+    id_remap remap = apply_order(g, csr, rcm);
+    assert(g.vertex_count() == 11 && g.vertex_index_bound() == 11);
+    assert(g.edge_index_bound() == 9);
+    for (int l = 0; l != 10; ++l)
+    {
+        vertex_id v = remap(by_label[l]);
+        assert(g.value(v) == l && g.index(v) == rcm[csr.dense_index(by_label[l])]);
+    }
+    for (int l = 0; l + 1 != 10; ++l)
+    {
+        vertex_id x = remap(by_label[l]);
+        vertex_id y = remap(by_label[l + 1]);
+        assert(g.get_edge(x, y) == remap(e[l]) && g.value(remap(e[l])) == l);
+        std::size_t ix = g.index(x);
+        std::size_t iy = g.index(y);
+        assert(ix + 1 == iy || iy + 1 == ix);   //路径上相邻的顶点在存储中也相邻
+    }
+    assert(g.associated_edges(remap(lonely)).empty());
+
+    directed_graph<int, int> d;
+    std::vector<vertex_id> dv;
+    for (int i = 0; i != 6; ++i)
+        dv.push_back(d.add_vertex(i));
+    for (int i = 0; i != 6; ++i)
+        d.add_edge(dv[i], dv[(i * 5 + 1) % 6], i);
+    csr_graph dcsr(d);
+    assert(dcsr.is_directed() && dcsr.entry_count() == 6);
+    vertex_order dp = gorder(dcsr);
+    assert(is_permutation_of_size(dp, 6) && is_permutation_of_size(reverse_cuthill_mckee(dcsr), 6));
+    id_remap dremap = apply_order(d, dcsr, dp);
+    for (int i = 0; i != 6; ++i)
+        assert(d.adjacent(dremap(dv[i]), dremap(dv[(i * 5 + 1) % 6])));
+
+    //vertex_map中已删除顶点的项被忽略,不会覆盖存在的顶点的值
+    undirected_graph<columnar<int>, int> c;
+    vertex_id c0 = c.add_vertex(10);
+    vertex_id c1 = c.add_vertex(11);
+    vertex_id c2 = c.add_vertex(12);
+    c.add_edge(c0, c2, 1);
+    c.remove_vertex(c1);
+    id_remap cremap = c.reorder({1, 1, 0});
+    assert(!cremap.contains(c1) && cremap(c1) == invalid_vertex_id);
+    assert(c.value(cremap(c0)) == 10 && c.value(cremap(c2)) == 12 && c.index(cremap(c2)) == 0);
+    assert(c.vertex_values()[0] == 12 && c.vertex_values()[1] == 10);
+}
+
+void test_compressed_graph()
+{
+    int const side = 30;
+    undirected_graph<int, null_value_tag> g;
+    std::vector<vertex_id> cell;
+    for (int i = 0; i != side * side; ++i)
+        cell.push_back(g.add_vertex(i));
+    for (int r = 0; r != side; ++r)
+        for (int c = 0; c != side; ++c)
+        {
+            if (c + 1 != side)
+                g.add_edge(cell[r * side + c], cell[r * side + c + 1]);
+            if (r + 1 != side)
+                g.add_edge(cell[r * side + c], cell[(r + 1) * side + c]);
+        }
+    vertex_id hub = g.add_vertex(-1);          //一个高度数顶点,既有单字节也有多字节的差值
+    for (int i = 0; i < side * side; i += (i < 200 ? 1 : 97))
+        g.add_edge(hub, cell[i]);
+    g.remove_vertex(cell[17]);
+
+    csr_graph csr(g);
+    for (compressed_graph const& z : {compressed_graph(csr), compressed_graph(g)})
+    {
+        assert(z.vertex_count() == csr.vertex_count() && z.entry_count() == csr.entry_count());
+        assert(!z.is_directed());
+        std::vector<compressed_graph::index_t> decoded;
+        for (csr_graph::index_t v = 0; v != csr.vertex_count(); ++v)
+        {
+            assert(z.vertex(v) == csr.vertex(v) && z.dense_index(csr.vertex(v)) == v);
+            assert(z.degree(v) == csr.degree(v) && z.neighbors(v).size() == csr.degree(v));
+            assert(std::equal(csr.neighbors(v).begin(), csr.neighbors(v).end(), z.neighbors(v).begin()));
+            decoded.clear();
+            z.decode_neighbors(v, decoded);
+            assert(std::equal(decoded.begin(), decoded.end(), csr.neighbors(v).begin(), csr.neighbors(v).end()));
+            for (auto u : csr.neighbors(v))
+                assert(z.adjacent(v, u));
+        }
+        assert(!z.adjacent(csr.dense_index(cell[0]), csr.dense_index(cell[2])));
+
+        std::vector<vertex_id> from_z;          //遍历接口:与原图到达相同的顶点,每条边恰好报告一次
+        std::vector<vertex_id> from_g;
+        for (vertex_id x : breadth_first(z, hub))
+            from_z.push_back(x);
+        for (vertex_id x : breadth_first(g, hub))
+            from_g.push_back(x);
+        std::sort(from_z.begin(), from_z.end());
+        std::sort(from_g.begin(), from_g.end());
+        assert(from_z == from_g && from_z.size() == g.vertex_count());
+        std::size_t reported = 0;
+        for (dfs_edge const& e : depth_first_edges(z))
+        {
+            assert(g.adjacent(e.from, e.to));
+            ++reported;
+        }
+        assert(reported == g.edge_count());
+    }
+    assert(closeness_centrality(compressed_graph(csr)) == closeness_centrality(csr));
+
+    csr_graph ordered = csr.permuted(reverse_cuthill_mckee(csr));
+    compressed_graph z(ordered);
+    std::size_t const csr_bytes = ordered.entry_count() * (sizeof(csr_graph::index_t) + sizeof(std::size_t)) +
+                                  ordered.vertex_count() * (sizeof(std::size_t) + sizeof(vertex_id) + sizeof(csr_graph::index_t));
+    assert(z.encoded_bytes() * 2 < csr_bytes && z.encoded_bytes() <= z.memory_usage());
+    std::size_t seen = 0;
+    for (compressed_graph::index_t v = 0; v != z.vertex_count(); ++v)
+        z.for_each_neighbor(v, [&](compressed_graph::index_t u)
+        {
+            assert(u < z.vertex_count());
+            ++seen;
+        });
+    assert(seen == z.entry_count());
+
+    directed_graph<int, int> d;
+    vertex_id a = d.add_vertex(0);
+    vertex_id b = d.add_vertex(1);
+    d.add_edge(b, a, 0);
+    compressed_graph dz(d);
+    assert(dz.is_directed() && dz.entry_count() == 1);
+    assert(dz.adjacent(dz.dense_index(b), dz.dense_index(a)) && !dz.adjacent(dz.dense_index(a), dz.dense_index(b)));
+    assert(*dz.neighbors(dz.dense_index(b)).begin() == dz.dense_index(a));
+    std::vector<vertex_id> preorder;
+    for (vertex_id x : depth_first_preorder(dz, a))
+        preorder.push_back(x);
+    assert(preorder == std::vector<vertex_id>{a});
+    assert(depth_first_edges(dz).begin()->kind == edge_kind::cross);     //a先于b完成
+}
+
+void test_subgraph_view()
+{
+    undirected_graph<int, double> g;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 8; ++i)
+        v.push_back(g.add_vertex(i));
+    std::vector<edge_id> e;
+    for (int i = 0; i != 8; ++i)
+        e.push_back(g.add_edge(v[i], v[(i + 1) % 8], i * 0.5));   //环,权重为i/2
+    edge_id chord = g.add_edge(v[0], v[4], 10.0);
+
+    auto even = induced_subgraph(g, [&](vertex_id x)
+    {
+        return g.value(x) % 2 == 0;
+    });
+    assert(even.vertex_count() == 4 && even.edge_count() == 1);
+    assert(even.contains(v[4]) && !even.contains(v[1]) && even.contains(chord) && !even.contains(e[0]));
+    assert(even.adjacent(v[0], v[4]) && !even.adjacent(v[0], v[1]) && even.get_edge(v[4], v[0]) == chord);
+    assert(even.associated_edges(v[2]).empty() && even.associated_edges(v[0]).size() == 1);
+    assert(even.value(v[6]) == 6 && even.value(chord) == 10.0);
+    int visited = 0;
+    for (auto x = even.first_vertex(); !even.vertex_end(x); x = even.next_vertex(x))
+        visited += g.value(x);
+    assert(visited == 0 + 2 + 4 + 6);
+
+    auto heavy = edge_subgraph(g, [&](edge_id x)
+    {
+        return g.value(x) >= 2.0;
+    });
+    assert(heavy.vertex_count() == 8 && heavy.edge_count() == 5);   //e[4..7]与chord
+    assert(heavy.neighbors(v[0]) == (std::vector<vertex_id>{v[7], v[4]}) || heavy.neighbors(v[0]) == (std::vector<vertex_id>{v[4], v[7]}));
+    assert(!heavy.associated(v[1], e[1]) && heavy.associated(v[5], e[5]));
+
+    std::vector<bool> vertex_bits(g.vertex_index_bound(), true);
+    std::vector<bool> edge_bits(g.edge_index_bound(), true);
+    vertex_bits[g.index(v[3])] = false;
+    edge_bits[g.index(chord)] = false;
+    auto masked = make_subgraph_view(g, index_mask(vertex_bits), index_mask(edge_bits));
+    assert(masked.vertex_count() == 7 && masked.edge_count() == 6);
+    csr_graph csr(masked);                      //按图的只读接口编写的代码可直接用于视图
+    assert(csr.vertex_count() == 7 && csr.entry_count() == 12);
+    assert(csr.degree(csr.dense_index(v[2])) == 1 && csr.degree(csr.dense_index(v[0])) == 2);
+
+    g.remove_edge(e[6]);                        //视图不保存结果,原图的修改立即可见
+    assert(heavy.edge_count() == 4 && !heavy.adjacent(v[6], v[7]));
+
+    directed_graph<int, int> d;
+    vertex_id a = d.add_vertex(0);
+    vertex_id b = d.add_vertex(1);
+    vertex_id c = d.add_vertex(2);
+    d.add_edge(a, b, 0);
+    d.add_edge(b, a, 1);
+    d.add_edge(b, c, 2);
+    auto dv = induced_subgraph(d, [&](vertex_id x)
+    {
+        return !(x == c);
+    });
+    assert(dv.is_directed && dv.edge_count() == 2 && dv.associated_edges(b).size() == 1);
+}
+
+void test_persistent_graph()
+{
+    undirected_graph<std::string, int> source;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 300; ++i)
+        v.push_back(source.add_vertex(std::to_string(i)));
+    for (int i = 0; i + 1 != 300; ++i)
+        source.add_edge(v[i], v[i + 1], i);
+    source.remove_vertex(v[100]);              //复制后id保持不变,空位可被复用
+
+    using graph_t = persistent_undirected_graph<std::string, int>;
+    graph_t base(source);
+    assert(base.vertex_count() == 299 && base.edge_count() == 297);
+    assert(!base.contains(v[100]) && base.value(v[7]) == "7");
+    assert(base.value(base.get_edge(v[7], v[8])) == 7 && base.associated_edges(v[101]).size() == 1);
+
+    std::vector<graph_t> variants;
+    for (int k = 0; k != 100; ++k)
+    {
+        variants.push_back(base.fork());        //O(1)
+        graph_t& g = variants.back();
+        g.value(v[k]) = "changed";
+        g.add_edge(v[k], v[299 - k], -k);
+        if (k % 2 == 0)
+            g.remove_edge(v[150 + k / 2], v[151 + k / 2]);
+    }
+    vertex_id fresh = variants[3].add_vertex("fresh");
+    assert(fresh == v[100]);
+    variants[3].add_edge(fresh, v[99], 100);
+
+    for (int k = 0; k != 100; ++k)
+    {
+        graph_t const& g = variants[k];
+        assert(g.value(v[k]) == "changed" && g.value(v[(k + 1) % 100]) != "changed");
+        assert(g.adjacent(v[k], v[299 - k]) && g.value(g.get_edge(v[299 - k], v[k])) == -k);
+        assert(g.adjacent(v[150 + k / 2], v[151 + k / 2]) == (k % 2 != 0));
+        assert(g.edge_count() == (k % 2 == 0 ? 297u : 298u) + (k == 3 ? 1 : 0));
+    }
+    assert(variants[3].contains(fresh) && !variants[4].contains(fresh) && variants[3].adjacent(fresh, v[99]));
+
+    //base不受任何副本的修改影响
+    assert(base.vertex_count() == 299 && base.edge_count() == 297);
+    for (int i = 0; i != 300; ++i)
+        if (i != 100)
+            assert(base.value(v[i]) == std::to_string(i));
+    assert(!base.adjacent(v[0], v[299]) && base.adjacent(v[150], v[151]));
+
+    graph_t copy = variants[0];                 //副本本身也可以继续fork
+    copy.remove_vertex(v[0]);
+    assert(variants[0].contains(v[0]) && !copy.contains(v[0]) && copy.associated_edges(v[1]).size() == 1);
+    assert(copy.associated_edges(v[299]).size() == 1);
+
+    //同一个图的不同副本可以在不同线程中同时修改,互不影响(两个副本是数据仅有的引用者)
+    graph_t right(source);
+    graph_t left = right.fork();
+    auto mutate = [&](graph_t& g, int shift)
+    {
+        for (int i = 0; i != 200; ++i)
+        {
+            g.value(v[i + (i >= 100)]) += "!";
+            g.add_edge(v[i + (i >= 100)], v[(i * 7 + shift) % 100], i);
+        }
+        g.remove_vertex(v[50 + shift]);
+    };
+    std::thread worker([&] { mutate(left, 1); });
+    mutate(right, 2);
+    worker.join();
+    assert(left.contains(v[52]) && !left.contains(v[51]) && right.contains(v[51]) && !right.contains(v[52]));
+    assert(left.value(v[0]) == "0!" && right.value(v[0]) == "0!" && base.value(v[0]) == "0");
+    assert(left.edge_count() != base.edge_count() && base.edge_count() == 297);
+}
+
+void test_adjacency_matrix()
+{
+    dense_undirected_graph<int, int> g;
+    undirected_graph<int, int> reference;
+    std::vector<vertex_id> v;
+    std::vector<vertex_id> r;
+    for (int i = 0; i != 100; ++i)              //超过64个顶点,矩阵需要扩张
+    {
+        v.push_back(g.add_vertex(i));
+        r.push_back(reference.add_vertex(i));
+    }
+    for (int i = 0; i != 100; ++i)
+        for (int j = i; j != 100; ++j)
+            if ((i * 7 + j * 3) % 5 != 0)
+            {
+                g.add_edge(v[i], v[j], i * 100 + j);
+                reference.add_edge(r[i], r[j], i * 100 + j);
+            }
+    for (int i = 0; i != 100; ++i)
+        for (int j = 0; j != 100; ++j)
+        {
+            assert(g.adjacent(v[i], v[j]) == reference.adjacent(r[i], r[j]));
+            if (g.adjacent(v[i], v[j]))
+                assert(g.value(g.get_edge(v[j], v[i])) == std::min(i, j) * 100 + std::max(i, j));
+        }
+    assert(g.neighbor_row(v[3]).count() == g.associated_edges(v[3]).size());
+    assert(g.memory_usage().adjacency < reference.memory_usage().adjacency);     //矩阵取代了每条边两个集合结点
+    for (int i = 0; i != 100; ++i)              //associated_edges由矩阵的行给出,按相邻顶点的index升序
+    {
+        std::vector<vertex_id> expected_neighbors;
+        for (vertex_id u : reference.neighbors(r[i]))
+            expected_neighbors.push_back(v[reference.index(u)]);
+        std::sort(expected_neighbors.begin(), expected_neighbors.end());
+        assert(g.neighbors(v[i]) == expected_neighbors);
+        for (auto const& e : g.associated_edges(v[i]))
+            assert(g.get_edge(v[i], e.opposite_vertex()) == e.edge() && g.associated(v[i], e.edge()));
+    }
+
+    std::vector<vertex_id> common = common_neighbors(g, v[1], v[2]);
+    std::size_t expected = 0;
+    for (int k = 0; k != 100; ++k)
+        if (g.adjacent(v[1], v[k]) && g.adjacent(v[2], v[k]))
+        {
+            assert(common[expected] == v[k]);
+            ++expected;
+        }
+    assert(common.size() == expected && common_neighbor_count(g, v[1], v[2]) == expected);
+    std::vector<vertex_id> either = neighbor_union(g, v[1], v[2]);
+    for (int k = 0; k != 100; ++k)
+        assert(std::count(either.begin(), either.end(), v[k]) == (g.adjacent(v[1], v[k]) || g.adjacent(v[2], v[k])));
+
+    g.remove_edge(v[1], v[0]);
+    assert(!g.adjacent(v[0], v[1]) && !g.neighbor_row(v[1]).test(g.index(v[0])));
+    edge_id again = g.add_edge(v[0], v[1], -1);     //不支持平行边,删除后才能再次连接
+    assert(g.get_edge(v[1], v[0]) == again && g.value(again) == -1);
+
+    g.remove_vertex(v[2]);
+    for (int k = 0; k != 100; ++k)
+        if (k != 2)
+            assert(!g.neighbor_row(v[k]).test(g.index(v[2])));
+    vertex_id reused = g.add_vertex(1000);
+    assert(g.index(reused) == g.index(v[2]) && g.associated_edges(reused).empty() && !g.adjacent(reused, v[3]));
+    g.add_edge(reused, v[3], 1);
+    assert(g.adjacent(v[3], reused));
+
+    g.remove_vertex(v[50]);
+    id_remap remap = g.compact();               //编号改变后索引被重建
+    assert(g.adjacent(remap(v[3]), remap(reused)) && g.value(g.get_edge(remap(v[3]), remap(reused))) == 1);
+    assert(g.adjacent(remap(v[99]), remap(v[98])) == reference.adjacent(r[99], r[98]));
+
+    dense_undirected_graph<int, int>::batch_t batch;
+    batch.add_edge(remap(v[4]), remap(v[4]), 44);
+    batch.remove_vertex(remap(v[5]));
+    g.apply(batch);                             //增量修改矩阵
+    assert(g.adjacent(remap(v[4]), remap(v[4])) && g.neighbor_row(remap(v[4])).test(g.index(remap(v[4]))));
+    std::size_t ends = 0;
+    for (auto u = g.first_vertex(); !g.vertex_end(u); u = g.next_vertex(u))
+        for (auto const& e : g.associated_edges(u))
+        {
+            auto pair = g.associated_vertices(e.edge());
+            assert((pair.first == u && pair.second == e.opposite_vertex()) ||
+                   (pair.second == u && pair.first == e.opposite_vertex()));
+            ends += pair.first == pair.second ? 2 : 1;
+        }
+    assert(ends == g.edge_count() * 2);
+    std::vector<std::size_t> reversed(g.vertex_index_bound());
+    std::size_t slot = g.vertex_count();
+    for (auto u = g.first_vertex(); !g.vertex_end(u); u = g.next_vertex(u))
+        reversed[g.index(u)] = --slot;
+    id_remap order = g.reorder(reversed);       //编号改变后按边重建矩阵
+    assert(g.adjacent(order(remap(v[4])), order(remap(v[4]))) &&
+           g.value(g.get_edge(order(remap(v[3])), order(remap(reused)))) == 1);
+    std::vector<vertex_id> reached;             //遍历与视图直接作用于矩阵的行
+    for (vertex_id u : breadth_first(g, order(remap(v[3]))))
+        reached.push_back(u);
+    assert(reached.size() == g.vertex_count() && induced_subgraph(g, accept_all()).edge_count() == g.edge_count());
+
+    dense_directed_graph<int, int> d;
+    vertex_id a = d.add_vertex(0);
+    vertex_id b = d.add_vertex(1);
+    vertex_id c = d.add_vertex(2);
+    d.add_edge(a, b, 0);
+    d.add_edge(c, b, 1);
+    assert(d.adjacent(a, b) && !d.adjacent(b, a) && d.value(d.get_edge(c, b)) == 1);
+    assert(common_neighbors(d, a, c) == std::vector<vertex_id>{b});
+    d.remove_edge(a, b);
+    assert(!d.adjacent(a, b) && d.adjacent(c, b));
+    d.remove_vertex(b);                         //入边也随之删除
+    assert(d.edge_count() == 0 && d.associated_edges(c).empty());
+
+    concurrent_graph_builder<dense_undirected_graph<int, int>> builder;
+    vertex_id x = builder.add_vertex(0);
+    vertex_id y = builder.add_vertex(1);
+    builder.add_edge(x, y, 5);
+    auto built = builder.finalize();
+    assert(built.adjacent(y, x) && built.value(built.get_edge(x, y)) == 5);
+}
+
+void test_traversal()
+{
+    //边: 0-1, 0-2, 1-3, 1-4, 2-5, 4-5; 6为孤立顶点
+    undirected_graph<int, int> g;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 7; ++i)
+        v.push_back(g.add_vertex(i));
+    g.add_edge(v[0], v[1], 0);
+    g.add_edge(v[0], v[2], 1);
+    g.add_edge(v[1], v[3], 2);
+    g.add_edge(v[1], v[4], 3);
+    g.add_edge(v[2], v[5], 4);
+    g.add_edge(v[4], v[5], 5);
+
+    std::vector<int> order;
+    std::vector<std::size_t> depth;
+    auto bfs = breadth_first(g, v[0]);
+    for (vertex_id x : bfs)
+    {
+        order.push_back(g.value(x));
+        depth.push_back(bfs.depth());
+    }
+    assert((order == std::vector<int>{0, 1, 2, 3, 4, 5}));
+    assert((depth == std::vector<std::size_t>{0, 1, 1, 2, 2, 2}));
+
+    order.clear();
+    auto early = breadth_first(g, v[3]);
+    for (vertex_id x : early)                   //找到目标即停止,其余顶点不会被访问
+    {
+        order.push_back(g.value(x));
+        if (x == v[1])
+            break;
+    }
+    assert((order == std::vector<int>{3, 1}));
+    assert(early.visited_vertex(v[0]) && !early.visited_vertex(v[2]));
+
+    order.clear();
+    for (vertex_id x : depth_first_preorder(g, v[0]))
+        order.push_back(g.value(x));
+    assert((order == std::vector<int>{0, 1, 3, 4, 5, 2}));
+    order.clear();
+    for (vertex_id x : depth_first_postorder(g, v[0]))
+        order.push_back(g.value(x));
+    assert((order == std::vector<int>{3, 2, 5, 4, 1, 0}));
+    order.clear();
+    for (vertex_id x : depth_first_preorder(g))
+        order.push_back(g.value(x));
+    assert(order.size() == 7 && order.back() == 6);
+
+    std::size_t tree = 0;
+    std::size_t back = 0;
+    for (dfs_edge const& e : depth_first_edges(g))
+    {
+        if (e.kind == edge_kind::tree)
+            ++tree;
+        else
+        {
+            assert(e.kind == edge_kind::back && e.edge == g.get_edge(v[2], v[0]));
+            ++back;
+        }
+    }
+    assert(tree == 5 && back == 1);             //每条边恰好一次
+
+    directed_graph<int, int> d;                 //0->1->2->0, 0->2, 3->2
+    std::vector<vertex_id> w;
+    for (int i = 0; i != 4; ++i)
+        w.push_back(d.add_vertex(i));
+    d.add_edge(w[0], w[1], 0);
+    d.add_edge(w[1], w[2], 1);
+    d.add_edge(w[2], w[0], 2);
+    d.add_edge(w[0], w[2], 3);
+    d.add_edge(w[3], w[2], 4);
+    std::vector<edge_kind> kinds;
+    for (dfs_edge const& e : depth_first_edges(d))
+        kinds.push_back(e.kind);
+    assert((kinds == std::vector<edge_kind>{edge_kind::tree, edge_kind::tree, edge_kind::back,
+                                             edge_kind::forward, edge_kind::cross}));
+    std::vector<int> reached;
+    for (vertex_id x : breadth_first(d, std::vector<vertex_id>{w[3]}))
+        reached.push_back(d.value(x));
+    assert((reached == std::vector<int>{3, 2, 0, 1}));
+
+    auto without_1 = induced_subgraph(g, [&](vertex_id x)
+    {
+        return !(x == v[1]);
+    });
+    order.clear();
+    for (vertex_id x : breadth_first(without_1, v[0]))
+        order.push_back(g.value(x));
+    assert((order == std::vector<int>{0, 2, 5, 4}));
+}
+
+void test_multi_source_bfs()
+{
+    undirected_graph<int, null_value_tag> g;
+    std::vector<vertex_id> v;
+    int const n = 600;
+    for (int i = 0; i != n; ++i)
+        v.push_back(g.add_vertex(i));
+    for (int i = 0; i != n; ++i)
+    {
+        if (i % 100 != 99)                      //6条各100个顶点的路径,再加一些弦
+            g.add_edge(v[i], v[i + 1]);
+        if (i % 7 == 0 && i + 13 < n && i / 100 == (i + 13) / 100)
+            g.add_edge(v[i], v[i + 13]);
+    }
+    g.add_edge(v[99], v[100]);                  //前两条路径相连
+
+    csr_graph csr(g);
+    std::vector<csr_graph::index_t> sources;
+    for (int i = 0; i != n; i += 2)
+        sources.push_back(csr.dense_index(v[i]));
+
+    //逐个源点做普通BFS作为参照
+    std::vector<double> closeness_ref;
+    std::vector<double> harmonic_ref;
+    std::vector<std::size_t> eccentricity_ref;
+    for (auto s : sources)
+    {
+        std::size_t reached = 0;
+        std::size_t sum = 0;
+        double harmonic = 0;
+        auto bfs = breadth_first(g, csr.vertex(s));
+        for (vertex_id x : bfs)
+            if (!(x == csr.vertex(s)))
+            {
+                ++reached;
+                sum += bfs.depth();
+                harmonic += 1.0 / static_cast<double>(bfs.depth());
+            }
+        closeness_ref.push_back(static_cast<double>(reached) / static_cast<double>(sum) * static_cast<double>(reached) / (n - 1));
+        harmonic_ref.push_back(harmonic);
+        eccentricity_ref.push_back(bfs.depth());
+    }
+    auto near = [](double a, double b)
+    {
+        return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+    };
+    std::vector<double> closeness = closeness_centrality(csr, sources);
+    std::vector<double> harmonic = harmonic_centrality(csr, sources);
+    assert(eccentricity(csr, sources) == eccentricity_ref);
+    for (std::size_t i = 0; i != sources.size(); ++i)
+        assert(near(closeness[i], closeness_ref[i]) && near(harmonic[i], harmonic_ref[i]));
+    assert(closeness_centrality(csr).size() == csr.vertex_count());
+
+    //较小的批,多个批;每个(顶点,源点)对恰好报告一次
+    multi_source_bfs bfs(csr, 128);
+    std::vector<std::size_t> reports(sources.size(), 0);
+    bfs.run(sources, [&](csr_graph::index_t, std::size_t, std::size_t first, bit_row reached)
+    {
+        assert(reached.word_count() == 2);
+        reached.for_each([&](std::size_t i)
+        {
+            ++reports[first + i];
+        });
+    });
+    for (std::size_t i = 0; i != sources.size(); ++i)
+        assert(reports[i] == (i < 100 ? 200u : 100u));
+
+    directed_graph<int, int> d;                 //0 -> 1 -> 2, 只沿出边
+    vertex_id a = d.add_vertex(0);
+    vertex_id b = d.add_vertex(1);
+    vertex_id c = d.add_vertex(2);
+    d.add_edge(a, b, 0);
+    d.add_edge(b, c, 0);
+    csr_graph dcsr(d);
+    std::vector<double> h = harmonic_centrality(dcsr);
+    assert(near(h[dcsr.dense_index(a)], 1.5) && near(h[dcsr.dense_index(b)], 1.0) && h[dcsr.dense_index(c)] == 0);
+}
+
+void test_betweenness()
+{
+    auto near = [](double a, double b)
+    {
+        return std::abs(a - b) <= 1e-9 * std::max(1.0, std::abs(b));
+    };
+    undirected_graph<int, int> path;            //0 - 1 - 2 - 3 - 4
+    std::vector<vertex_id> p;
+    for (int i = 0; i != 5; ++i)
+        p.push_back(path.add_vertex(i));
+    for (int i = 0; i != 4; ++i)
+        path.add_edge(p[i], p[i + 1], 1);
+    csr_graph pcsr(path);
+    std::vector<double> expected = {0, 3, 4, 3, 0};
+    for (std::size_t threads : {1, 4})
+    {
+        std::vector<double> b = betweenness_centrality(pcsr, threads);
+        for (int i = 0; i != 5; ++i)
+            assert(near(b[pcsr.dense_index(p[i])], expected[i]));
+    }
+
+    undirected_graph<int, int> square;          //0 - 1 - 2 - 3 - 0, 边3 - 0的长度为5
+    std::vector<vertex_id> q;
+    for (int i = 0; i != 4; ++i)
+        q.push_back(square.add_vertex(i));
+    for (int i = 0; i != 4; ++i)
+        square.add_edge(q[i], q[(i + 1) % 4], i == 3 ? 5 : 1);
+    csr_graph qcsr(square);
+    std::vector<double> unweighted = betweenness_centrality(qcsr);
+    std::vector<double> weighted = betweenness_centrality(square, qcsr, [](int w) { return w; });
+    std::vector<double> unit = betweenness_centrality(square, qcsr, [](int) { return 1; }, 2);
+    for (int i = 0; i != 4; ++i)
+    {
+        std::size_t x = qcsr.dense_index(q[i]);
+        assert(near(unweighted[x], 0.5) && near(unit[x], 0.5));
+        assert(near(weighted[x], i == 1 || i == 2 ? 2 : 0));
+    }
+
+    directed_graph<int, int> d;                 //0 -> 1 -> 2, 0 -> 2不经过1
+    vertex_id a = d.add_vertex(0);
+    vertex_id b = d.add_vertex(1);
+    vertex_id c = d.add_vertex(2);
+    vertex_id e = d.add_vertex(3);
+    d.add_edge(a, b, 0);
+    d.add_edge(b, c, 0);
+    d.add_edge(c, e, 0);
+    d.add_edge(a, c, 0);
+    csr_graph dcsr(d);
+    std::vector<double> db = betweenness_centrality(dcsr);
+    assert(near(db[dcsr.dense_index(a)], 0) && near(db[dcsr.dense_index(b)], 0));
+    assert(near(db[dcsr.dense_index(c)], 2) && near(db[dcsr.dense_index(e)], 0));   //0 -> 3与1 -> 3
+
+    undirected_graph<int, null_value_tag> g;    //较大的图上,抽样估计与精确值的归一化误差在epsilon以内
+    std::vector<vertex_id> v;
+    int const n = 1000;
+    for (int i = 0; i != n; ++i)
+        v.push_back(g.add_vertex(i));
+    for (int i = 0; i + 1 != n; ++i)
+    {
+        g.add_edge(v[i], v[(i * 37 + 11) % (i + 1)]);       //随机树
+        if (i % 5 == 0)
+            g.add_edge(v[i], v[(i * 7 + 3) % n]);
+    }
+    csr_graph csr(g);
+    double const epsilon = 0.1;
+    double const delta = 0.1;
+    std::size_t const k = betweenness_sample_size(n, epsilon, delta);
+    assert(k > 0 && k < n && betweenness_sample_size(n, epsilon / 2, delta) >= 4 * k - 3);
+    assert(betweenness_sample_size(0, epsilon, delta) == 0);
+    assert(betweenness_sample_size(n, 1e-200, delta) == std::size_t(-1));     //超出范围时取最大值,而不是溢出
+    std::vector<double> exact = betweenness_centrality(csr);
+    std::vector<double> single = betweenness_centrality(csr, 1);
+    for (std::size_t i = 0; i != exact.size(); ++i)
+        assert(near(exact[i], single[i]));
+    std::vector<double> estimate = approximate_betweenness_centrality(csr, epsilon, delta, 42);
+    std::vector<double> again = approximate_betweenness_centrality(csr, epsilon, delta, 42, 3);   //同一种子,线程数不影响抽样
+    for (std::size_t i = 0; i != exact.size(); ++i)
+        assert(near(estimate[i], again[i]));
+    double const pairs = (n - 1.0) * (n - 2.0) / 2;
+    for (std::size_t i = 0; i != exact.size(); ++i)
+        assert(std::abs(estimate[i] - exact[i]) / pairs <= epsilon);
+}
+
+void test_reachability()
+{
+    directed_graph<int, null_value_tag> g;
+    std::vector<vertex_id> v;
+    int const n = 300;
+    vertex_id gap;
+    for (int i = 0; i != n; ++i)
+    {
+        if (i == n / 2)
+            gap = g.add_vertex(-1);
+        v.push_back(g.add_vertex(i));
+    }
+    for (int i = 0; i != n; ++i)            //大多指向更大的编号,少数指回去形成环
+    {
+        g.add_edge(v[i], v[(i * 17 + 5) % n]);
+        if (i % 3 == 0)
+            g.add_edge(v[i], v[(i + 1) % n]);
+        if (i % 11 == 0)
+            g.add_edge(v[(i * 7) % n], v[i / 2]);
+    }
+    g.remove_vertex(gap);                   //index不连续
+
+    auto check = [&](reachability_index const& index)
+    {
+        assert(!index.contains(gap));
+        for (int i = 0; i != n; ++i)
+        {
+            std::vector<bool> expected(g.vertex_index_bound(), false);
+            for (vertex_id x : breadth_first(g, v[i]))
+                expected[g.index(x)] = true;
+            for (int j = 0; j != n; ++j)
+                assert(index.reachable(v[i], v[j]) == expected[g.index(v[j])]);
+        }
+    };
+    reachability_index index(g, 3, 3, 7);
+    assert(index.component_count() < g.vertex_count() && index.label_count() == 3);
+    check(index);
+    for (int i = 0; i != n; ++i)
+        if (index.same_component(v[i], v[(i + 1) % n]))
+            assert(index.reachable(v[(i + 1) % n], v[i]));
+
+    std::stringstream stream;               //序列化后读回
+    index.save(stream);
+    reachability_index loaded = reachability_index::load(stream);
+    check(loaded);
+    std::string bytes = stream.str();
+    std::stringstream truncated(bytes.substr(0, bytes.size() / 2));
+    bool thrown = false;
+    try
+    {
+        reachability_index::load(truncated);
+    }
+    catch (exceptions::bad_reachability_index_stream const&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    directed_graph<int, null_value_tag> pair;   //两个分量;标签数改为3 + 2^63后,2 * labels溢出回到区间数,仍须被拒绝
+    pair.add_vertex(0);
+    pair.add_vertex(1);
+    std::stringstream forged;
+    reachability_index(pair, 3).save(forged);
+    std::string forged_bytes = forged.str();
+    std::uint64_t huge = 3 + (std::uint64_t(1) << 63);
+    std::copy(reinterpret_cast<char const*>(&huge), reinterpret_cast<char const*>(&huge) + sizeof(huge),
+              forged_bytes.begin() + 8);
+    std::stringstream forged_in(forged_bytes);
+    thrown = false;
+    try
+    {
+        reachability_index::load(forged_in);
+    }
+    catch (exceptions::bad_reachability_index_stream const&)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    //已可达的一对之间加边不改变可达关系,索引仍然有效;其它修改后重新构造
+    assert(index.reachable(v[0], v[(17 * 17 + 5) % n]));
+    g.add_edge(v[0], v[(17 * 17 + 5) % n]);
+    check(index);
+    g.add_edge(v[299], v[0]);
+    check(reachability_index(g, 1, 1));
+
+    std::vector<std::thread> readers;       //并发查询
+    for (int t = 0; t != 4; ++t)
+        readers.emplace_back([&]
+        {
+            for (int i = 0; i < n; i += 7)
+                assert(loaded.reachable(v[i], v[i]) && loaded.reachable(v[i], v[(i * 17 + 5) % n]));
+        });
+    for (auto& r : readers)
+        r.join();
+}
+
+void test_keyed_graph()
+{
+    keyed_graph<undirected_graph<std::string, int>> g;  //以字符串为键导入边表
+    std::vector<std::pair<char const*, char const*>> edges = {{"a", "b"}, {"b", "c"}, {"c", "a"}, {"a", "d"}};
+    for (auto const& e : edges)
+        g.add_edge(g.get_or_add_vertex(e.first), g.get_or_add_vertex(e.second), 1);
+    assert(g.vertex_count() == 4 && g.key_count() == 4 && g.edge_count() == 4);
+    std::pair<bool, vertex_id> a = g.find_vertex("a");
+    assert(a.first && g.value(a.second) == "a" && g.associated_edges(a.second).size() == 3);
+    assert(g.find_vertex(std::string("d")).first && !g.find_vertex("e").first);
+    assert(g.get_or_add_vertex(std::string("b")) == g.find_vertex("b").second);
+    g.remove_vertex(g.find_vertex("c").second);
+    assert(!g.find_vertex("c").first && g.key_count() == 3);
+    vertex_id c = g.get_or_add_vertex("c");
+    assert(g.find_vertex("c").second == c && g.associated_edges(c).empty());
+
+    keyed_graph<undirected_graph<std::string, int>>::batch_t batch;     //批量删除
+    batch.remove_vertex(g.find_vertex("d").second);
+    g.apply(batch);
+    assert(!g.find_vertex("d").first && g.key_count() == 3);
+    g.compact();                                //重新编号后索引随之重建
+    for (char const* k : {"a", "b", "c"})
+        assert(g.key(g.find_vertex(k).second) == k);
+    assert(g.memory_usage().key_index > 0);
+
+    struct user
+    {
+        int id;
+        double score;
+    };
+    struct by_id
+    {
+        int operator()(user const& u) const
+        {
+            return u.id;
+        }
+    };
+    keyed_graph<directed_graph<user, null_value_tag>, by_id> users;    //按投影出的字段建立索引
+    int const n = 5000;
+    users.reserve(n, 0);
+    for (int i = 0; i != n; ++i)
+        users.add_vertex(user{i * 7, 0.5});
+    for (int i = 0; i < n; i += 2)
+        users.remove_vertex(users.find_vertex(i * 7).second);
+    for (int i = 0; i != n; ++i)
+    {
+        std::pair<bool, vertex_id> r = users.find_vertex(i * 7);
+        assert(r.first == (i % 2 != 0) && (!r.first || users.value(r.second).id == i * 7));
+    }
+    vertex_id u = users.get_or_add_vertex(14, user{14, 1.0});
+    assert(users.value(u).score == 1.0 && users.get_or_add_vertex(14, user{14, 2.0}) == u);
+    assert(users.key_count() == users.vertex_count() && users.key_count() == n / 2 + 1);
+}
+
+void test_partition()
+{
+    undirected_graph<int, null_value_tag> g;    //40x40的网格
+    int const side = 40;
+    std::vector<vertex_id> v;
+    for (int i = 0; i != side * side; ++i)
+        v.push_back(g.add_vertex(i));
+    for (int r = 0; r != side; ++r)
+        for (int c = 0; c != side; ++c)
+        {
+            if (c + 1 != side)
+                g.add_edge(v[r * side + c], v[r * side + c + 1]);
+            if (r + 1 != side)
+                g.add_edge(v[r * side + c], v[(r + 1) * side + c]);
+        }
+    for (std::size_t parts : {2, 4, 7})
+    {
+        graph_partition p = partition_graph(g, parts, 0.05, 1);
+        assert(p.part_count() == parts);
+        std::size_t const limit = static_cast<std::size_t>(std::ceil(side * side / double(parts) * 1.05));
+        std::size_t total = 0;
+        for (std::size_t q = 0; q != parts; ++q)
+        {
+            assert(p.part_size(q) <= limit && p.part_size(q) > 0);
+            total += p.part_size(q);
+        }
+        assert(total == g.vertex_count());
+        std::size_t cut = 0;
+        for (auto x = g.first_vertex(); !g.vertex_end(x); x = g.next_vertex(x))
+            for (auto const& e : g.associated_edges(x))
+                if (p.part(x) != p.part(e.opposite_vertex()))
+                    ++cut;
+        assert(cut / 2 == p.edge_cut());
+        assert(p.edge_cut() <= 40 * parts);     //随机划分约为2000以上,按条带划分为40 * (parts - 1)
+    }
+
+    graph_partition p = partition_graph(g, 4, 0.03, 2);     //分片与ghost表
+    std::vector<graph_shard> shards = make_shards(g, p);
+    std::size_t owned = 0;
+    std::size_t ghosts = 0;
+    for (graph_shard const& s : shards)
+    {
+        owned += s.owned_count();
+        ghosts += s.ghost_count();
+        for (graph_shard::index_t i = 0; i != s.vertex_count(); ++i)
+        {
+            vertex_id x = s.vertex(i);
+            assert(s.local_index(x) == i && s.owner(i) == p.part(x));
+            assert(shards[s.owner(i)].vertex(s.remote_index(i)) == x && s.is_ghost(i) == (s.owner(i) != s.part()));
+        }
+        for (graph_shard::index_t i = 0; i != s.owned_count(); ++i)
+        {
+            assert(s.degree(i) == g.associated_edges(s.vertex(i)).size());
+            for (auto u : s.neighbors(i))
+                assert(g.adjacent(s.vertex(i), s.vertex(u)));
+        }
+    }
+    assert(owned == g.vertex_count() && ghosts <= 2 * p.edge_cut() && ghosts > 0);
+    for (graph_shard const& s : shards)
+    {
+        std::size_t present = 0;
+        for (vertex_id x : v)
+            present += s.local_index(x) != graph_shard::npos;
+        assert(present == s.vertex_count());
+    }
+
+    undirected_graph<int, null_value_tag> islands;     //互不相连的几块,以及一个孤立顶点
+    std::vector<vertex_id> w;
+    for (int i = 0; i != 301; ++i)
+        w.push_back(islands.add_vertex(i));
+    for (int i = 0; i + 1 < 300; ++i)
+        if (i % 100 != 99)
+            islands.add_edge(w[i], w[i + 1]);
+    graph_partition q = partition_graph(islands, 3, 0.1);
+    assert(q.edge_cut() <= 3);
+    for (std::size_t r = 0; r != 3; ++r)
+        assert(q.part_size(r) <= 111);
+    assert(partition_graph(islands, 1).edge_cut() == 0);
+}
+
+void test_random_walk()
+{
+    undirected_graph<int, int> g;               //三角形0 - 1 - 2,另有1 - 3;边1 - 3的权重为9
+    std::vector<vertex_id> v;
+    for (int i = 0; i != 4; ++i)
+        v.push_back(g.add_vertex(i));
+    g.add_edge(v[0], v[1], 1);
+    g.add_edge(v[1], v[2], 1);
+    g.add_edge(v[2], v[0], 1);
+    g.add_edge(v[1], v[3], 9);
+    csr_graph csr(g);
+    auto d = [&](int i)
+    {
+        return csr.dense_index(v[i]);
+    };
+    std::vector<csr_graph::index_t> starts(5000, d(1));
+    for (std::size_t i = 0; i < starts.size(); i += 2)
+        starts[i] = d(0);
+
+    random_walker uniform(csr);                 //每一步都沿着边,结果与线程数无关
+    walk_buffer walks = uniform.run(starts, 10, 3, 1);
+    assert(walks.walk_count() == starts.size() && walks.walk_length() == 10);
+    for (std::size_t i = 0; i != walks.walk_count(); ++i)
+    {
+        auto w = walks.walk(i);
+        assert(w.size() == 10 && w[0] == starts[i]);
+        for (std::size_t k = 1; k != w.size(); ++k)
+            assert(std::binary_search(csr.neighbors(w[k - 1]).begin(), csr.neighbors(w[k - 1]).end(), w[k]));
+    }
+    walk_buffer parallel = uniform.run(starts, 10, 3, 4);
+    assert(std::equal(walks.data(), walks.data() + 10 * starts.size(), parallel.data()));
+
+    random_walker weighted(g, csr, [](int w) { return w; });   //从1出发,第一步到3的概率为9 / 11
+    walk_buffer heavy = weighted.run(std::vector<csr_graph::index_t>(10000, d(1)), 2, 5);
+    std::size_t to_leaf = 0;
+    for (std::size_t i = 0; i != heavy.walk_count(); ++i)
+        to_leaf += heavy.walk(i)[1] == d(3);
+    assert(to_leaf > 7900 && to_leaf < 8450);
+
+    random_walker node2vec(csr);                //p, q都很大:0 -> 1之后既不返回0也不走远到3,只能到2
+    node2vec.set_node2vec(1e9, 1e9);
+    walk_buffer local = node2vec.run(starts, 3, 7);
+    std::size_t seen = 0;
+    for (std::size_t i = 0; i != local.walk_count(); ++i)
+        if (local.walk(i)[0] == d(0) && local.walk(i)[1] == d(1))
+        {
+            ++seen;
+            assert(local.walk(i)[2] == d(2));
+        }
+    assert(seen > 0);
+    node2vec.set_node2vec(1e9, 0.01);           //q很小:倾向于离开三角形
+    walk_buffer outward = node2vec.run(starts, 3, 7);
+    std::size_t out = 0;
+    seen = 0;
+    for (std::size_t i = 0; i != outward.walk_count(); ++i)
+        if (outward.walk(i)[0] == d(0) && outward.walk(i)[1] == d(1))
+        {
+            ++seen;
+            out += outward.walk(i)[2] == d(3);
+        }
+    assert(out * 100 > seen * 95);
+
+    directed_graph<int, null_value_tag> chain;  //没有出边时提前结束
+    vertex_id a = chain.add_vertex(0);
+    vertex_id b = chain.add_vertex(1);
+    chain.add_edge(a, b);
+    csr_graph chain_csr(chain);
+    walk_buffer short_walks = random_walker(chain_csr).run({chain_csr.dense_index(a)}, 5);
+    assert(short_walks.walk(0).size() == 2 && short_walks.walk(0)[1] == chain_csr.dense_index(b));
+
+    std::stringstream text;                     //按行写出顶点的index
+    uniform.write(text, starts, 4, 3, 2);
+    std::string line;
+    std::size_t lines = 0;
+    while (std::getline(text, line))
+    {
+        std::istringstream tokens(line);
+        std::size_t x;
+        std::size_t count = 0;
+        while (tokens >> x)
+            ++count;
+        assert(count == 4);
+        ++lines;
+    }
+    assert(lines == starts.size());
+}
+
 int main()
 {
     white_box_test().test();
     test_undirected_graph()();
     test_directed_graph();
+    test_memory_usage_and_instrumentation();
+    test_allocator();
+    test_null_value_edges();
+    test_columnar_values();
+    test_concurrent_graph();
+    test_concurrent_builder();
+    test_mutation_batch();
+    test_compact();
+    test_reorder();
+    test_compressed_graph();
+    test_subgraph_view();
+    test_persistent_graph();
+    test_adjacency_matrix();
+    test_traversal();
+    test_multi_source_bfs();
+    test_betweenness();
+    test_reachability();
+    test_keyed_graph();
+    test_partition();
+    test_random_walk();
     cout << "Success!成功" << endl;
     return 0;
 }